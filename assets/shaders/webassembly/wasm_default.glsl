@@ -2,41 +2,72 @@
 #version 300 es
 precision highp float;
 in vec3 position;
-in vec3 normal;
+in vec2 normal; // Octahedral encoded
 in vec4 uv01;
-in vec3 tangent;
-in vec3 bitangent;
+in vec4 tangent; // The bitangent's handedness in w
 out vec2 v_uv0;
 out vec2 v_uv1;
 out vec3 v_normal;
 out vec4 v_world_position;
 out mat3 v_tbn;
+flat out int v_material_index;
 
-uniform mat4 model_matrix;
-uniform mat4 mvp;
+// Per instance, see RenderQueue
+layout (location = 8) in mat4 instance_model_matrix;
+layout (location = 12) in float instance_material_index;
+
+struct PointLight
+{
+    vec3 position;
+    vec3 color;
+};
+
+// Shared by every draw, updated once a frame
+layout (std140) uniform FrameData
+{
+    mat4 view_projection;
+    vec3 camera_position;
+    int point_light_count;
+    PointLight point_lights[10];
+};
+
+vec3 decode_octahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -fold : fold;
+    normal.y += normal.y >= 0.0 ? -fold : fold;
+    return normalize(normal);
+}
 
 void main()
 {
-    vec3 t = normalize(vec3(model_matrix * vec4(tangent, 0.0)));
-    vec3 b = normalize(vec3(model_matrix * vec4(bitangent, 0.0)));
-    vec3 n = normalize(vec3(model_matrix * vec4(normal, 0.0)));
+    vec3 model_normal = decode_octahedral(normal);
+    vec3 model_bitangent = cross(model_normal, tangent.xyz) * tangent.w;
+
+    vec3 t = normalize(vec3(instance_model_matrix * vec4(tangent.xyz, 0.0)));
+    vec3 b = normalize(vec3(instance_model_matrix * vec4(model_bitangent, 0.0)));
+    vec3 n = normalize(vec3(instance_model_matrix * vec4(model_normal, 0.0)));
     v_tbn = mat3(t, b, n);
 
     v_uv0 = uv01.xy;
     v_uv1 = uv01.zw;
-    v_normal = normal;
-    v_world_position = model_matrix * vec4(position, 1);
-    gl_Position = mvp * vec4(position, 1);
+    v_normal = model_normal;
+    v_world_position = instance_model_matrix * vec4(position, 1);
+    gl_Position = view_projection * v_world_position;
+    v_material_index = int(instance_material_index + 0.5);
 }
 
 #shader fragment
 #version 300 es
 precision highp float;
+precision highp int;
 in vec2 v_uv0;
 in vec2 v_uv1;
 in vec3 v_normal;
 in vec4 v_world_position;
 in mat3 v_tbn;
+flat in int v_material_index;
 layout (location = 0) out vec4 FragColor;
 layout (location = 1) out vec4 LightColor;
 
@@ -44,14 +75,6 @@ uniform sampler2D diffuse_map;
 uniform sampler2D normal_map;
 uniform sampler2D light_map;
 uniform samplerCube sky_box;
-uniform vec3 camera_position;
-uniform vec3 color;
-uniform vec3 specular_color;
-uniform vec3 emission_color;
-uniform float normal_map_strength;
-uniform float specular_focus;
-uniform float metallic;
-uniform bool has_light_map;
 
 struct PointLight
 {
@@ -59,8 +82,33 @@ struct PointLight
     vec3 color;
 };
 
-uniform PointLight point_lights[10];
-uniform int point_light_count;
+// Shared by every draw, updated once a frame
+layout (std140) uniform FrameData
+{
+    mat4 view_projection;
+    vec3 camera_position;
+    int point_light_count;
+    PointLight point_lights[10];
+};
+
+struct MaterialData
+{
+    vec3 color;
+    float normal_map_strength;
+    vec3 specular_color;
+    float specular_focus;
+    vec3 emission_color;
+    float metallic;
+    int has_light_map;
+};
+
+// Every material in the scene, uploaded when they change
+layout (std140) uniform Materials
+{
+    MaterialData materials[256];
+};
+
+MaterialData material;
 
 void calculate_directional_light(
     vec3 normal, vec3 view_direction,
@@ -75,7 +123,7 @@ void calculate_directional_light(
     diffuse_light += sun_color * max(angle_from_light, 0.0) * intensity;
 
     vec3 reflect_direction = reflect(light_direction, -normal);
-    specular_light += sun_color * pow(max(dot(view_direction, reflect_direction), 0.0), specular_focus) * intensity;
+    specular_light += sun_color * pow(max(dot(view_direction, reflect_direction), 0.0), material.specular_focus) * intensity;
 }
 
 void calculate_point_lights(
@@ -92,7 +140,7 @@ void calculate_point_lights(
         diffuse_light += light.color * (max(angle_from_light, 0.0) / att_factor);
 
         vec3 reflect_direction = reflect(to_light_direction, normal);
-        float specular_intensity = pow(max(dot(view_direction, reflect_direction), 0.0), specular_focus);
+        float specular_intensity = pow(max(dot(view_direction, reflect_direction), 0.0), material.specular_focus);
         specular_light += light.color * (specular_intensity / att_factor);
     }
 }
@@ -106,10 +154,13 @@ vec3 calculate_metallic_color(vec3 normal, vec3 view_direction)
 void main()
 {
     const float ambaint_light = 0.05;
+    material = materials[v_material_index];
 
     // Compute normal map
-    vec3 normal = texture(normal_map, v_uv0).xyz;
-    normal = mix(vec3(0, 0, 1), normal * 2.0 - 1.0, normal_map_strength);
+    // Compressed normal maps only keep x and y, so z is rebuilt
+    vec2 normal_xy = texture(normal_map, v_uv0).xy * 2.0 - 1.0;
+    vec3 normal = vec3(normal_xy, sqrt(max(1.0 - dot(normal_xy, normal_xy), 0.0)));
+    normal = mix(vec3(0, 0, 1), normal, material.normal_map_strength);
     normal = normalize(v_tbn * normal);
 
     // Direction pointing to the camera
@@ -123,16 +174,16 @@ void main()
     calculate_point_lights(normal, view_direction, diffuse_light, specular_light);
 
     // Apply light map, if we have one
-    if (has_light_map)
+    if (material.has_light_map != 0)
         diffuse_light *= texture(light_map, v_uv1).rgb;
 
     // Compute final pixel color
     vec3 metallic_color = calculate_metallic_color(normal, view_direction);
-    vec3 diffuse_color = mix(texture(diffuse_map, v_uv0).rgb, metallic_color, metallic);
+    vec3 diffuse_color = mix(texture(diffuse_map, v_uv0).rgb, metallic_color, material.metallic);
     vec3 final_color = 
-        color * diffuse_color * max(diffuse_light, vec3(ambaint_light)) +
-        specular_color * min(specular_light, vec3(1.0)) + 
-        emission_color;
+        material.color * diffuse_color * max(diffuse_light, vec3(ambaint_light)) +
+        material.specular_color * min(specular_light, vec3(1.0)) + 
+        material.emission_color;
     FragColor = vec4(final_color, 1.0);
-    LightColor = vec4(emission_color, 1.0);
+    LightColor = vec4(material.emission_color, 1.0);
 }
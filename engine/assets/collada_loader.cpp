@@ -6,7 +6,11 @@
 
 #include "collada_loader.hpp"
 #include "asset_repository.hpp"
+#include "model_snapshot.hpp"
 #include "engine/graphics/mesh/mesh_builder.hpp"
+#include "engine/graphics/mesh/mesh_optimizer.hpp"
+#include "engine/graphics/mesh/mesh_simplifier.hpp"
+#include "engine/logger.hpp"
 #include "engine/graphics/texture/image_texture.hpp"
 #include "gameobject/gameobject.hpp"
 #include <glm/glm.hpp>
@@ -185,19 +189,30 @@ static MeshBuilder load_mesh(pugi::xml_node const& mesh_node)
     return builder;
 }
 
-static std::map<std::string, MeshBuilder> load_meshes(
-    pugi::xml_node const& meshes_node)
+static std::map<std::string, ColladaLoader::MeshLevels> load_meshes(
+    pugi::xml_node const& meshes_node,
+    MeshOptimizer::Stats& stats)
 {
-    std::map<std::string, MeshBuilder> meshes;
+    std::map<std::string, ColladaLoader::MeshLevels> meshes;
     for (auto const& geometry_node : meshes_node.children("geometry")) {
         auto const& id = geometry_node.attribute("id").as_string();
         auto mesh = load_mesh(geometry_node.child("mesh"));
-        meshes[id] = mesh;
+        stats += MeshOptimizer::optimize(mesh);
+        meshes[id] = { std::move(mesh) };
     }
 
     return meshes;
 }
 
+// Once per mesh rather than per node using it. Models are loaded on the
+// loading threads, so this stays off the frame.
+static void build_lods(std::map<std::string, ColladaLoader::MeshLevels>& meshes, int level_count)
+{
+    for (auto& [id, levels] : meshes) {
+        levels = MeshSimplifier::build_lods(levels.front(), level_count);
+    }
+}
+
 static std::map<std::string, std::shared_ptr<Texture>> load_images(
     AssetRepository const& assets,
     pugi::xml_node const& images_node)
@@ -426,25 +441,33 @@ static glm::vec3 load_rotation(pugi::xml_node const& node_node)
     return rotation;
 }
 
-GameObject* ColladaLoader::open(
-    GameObject& parent, AssetRepository const& assets, std::string_view model_name,
-    std::function<void(GameObject&, Engine::MeshBuilder&, ModelMetaData)> const& on_object)
+bool ColladaLoader::for_each_node(AssetRepository const& assets, std::string_view model_name, OnNode const& on_node, int level_count)
 {
+#ifdef MODEL_SNAPSHOTS
+    if (ModelSnapshot::for_each_node(assets, ModelSnapshot::name_for(model_name), on_node, level_count)) {
+        return true;
+    }
+#endif
+
     pugi::xml_document doc;
 
     auto result = doc.load(*assets.open(model_name));
     if (!result) {
         std::cerr << "Error: Parsing Collada file: " << result.description() << "\n";
-        return nullptr;
+        return false;
     }
 
     auto const& root = doc.child("COLLADA");
     auto image_library = load_images(assets, root.child("library_images"));
     auto effect_library = load_effects(assets, image_library, root.child("library_effects"));
     auto material_library = load_materials(effect_library, root.child("library_materials"));
-    auto mesh_library = load_meshes(root.child("library_geometries"));
+    MeshOptimizer::Stats stats;
+    auto mesh_library = load_meshes(root.child("library_geometries"), stats);
+    Logger::on_model_optimized(model_name, stats);
+    if (level_count > 1) {
+        build_lods(mesh_library, level_count);
+    }
 
-    auto& model_object = parent.add_child();
     auto const& visual_scenes_node = root.child("library_visual_scenes");
     for (auto const& visual_scene_node : visual_scenes_node.children("visual_scene")) {
         for (auto const& node_node : visual_scene_node.children("node")) {
@@ -458,18 +481,48 @@ GameObject* ColladaLoader::open(
                                           .child("instance_material")
                                           .attribute("target");
 
-            auto& mesh = mesh_library[parse_id_selector(mesh_id)];
+            // An unknown mesh is drawn as an empty one, as it always has
+            auto& levels = mesh_library[parse_id_selector(mesh_id)];
+            if (levels.empty()) {
+                levels.emplace_back();
+            }
+
             auto& material = material_library[parse_id_selector(material_id)];
-            auto& game_object = model_object.add_child();
-            on_object(game_object, mesh, ModelMetaData {
-                                             .name = name,
-                                             .material = material,
-                                             .translation = load_vec3(node_node.child("translate")),
-                                             .scale = load_vec3(node_node.child("scale")),
-                                             .rotation = load_rotation(node_node),
-                                         });
+            on_node(levels, ModelMetaData {
+                              .name = name,
+                              .material = material,
+                              .translation = load_vec3(node_node.child("translate")),
+                              .scale = load_vec3(node_node.child("scale")),
+                              .rotation = load_rotation(node_node),
+                          });
         }
     }
 
-    return &model_object;
+    return true;
+}
+
+GameObject* ColladaLoader::open(
+    GameObject& parent, AssetRepository const& assets, std::string_view model_name,
+    std::function<void(GameObject&, MeshLevels&, ModelMetaData)> const& on_object,
+    int level_count)
+{
+    // Nothing's called back on failure, so the object's only made once
+    // the model's known to have loaded
+    GameObject* model_object = nullptr;
+    auto has_loaded = for_each_node(
+        assets, model_name, [&](MeshLevels& levels, ModelMetaData meta_data) {
+            if (!model_object) {
+                model_object = &parent.add_child();
+            }
+            on_object(model_object->add_child(), levels, std::move(meta_data));
+        },
+        level_count);
+
+    if (!has_loaded) {
+        return nullptr;
+    }
+    if (!model_object) {
+        model_object = &parent.add_child();
+    }
+    return model_object;
 }
@@ -12,6 +12,7 @@
 #include <functional>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 
 namespace Engine::ColladaLoader {
 
@@ -23,8 +24,22 @@ struct ModelMetaData {
     glm::vec3 rotation { 0, 0, 0 };
 };
 
+// Level 0 is the mesh as modelled, each level after is simpler, for
+// drawing at a distance
+using MeshLevels = std::vector<MeshBuilder>;
+
+using OnNode = std::function<void(MeshLevels&, ModelMetaData)>;
+
+// Calls back with each node's mesh, without making any objects. Up to
+// level_count levels are given, from the snapshot if baked into it,
+// otherwise built once per mesh as the model loads. Returns false, having
+// called nothing, if the model couldn't be loaded.
+bool for_each_node(AssetRepository const&, std::string_view name, OnNode const& on_node, int level_count = 1);
+
+// Makes an object holding one child per node
 Object::GameObject* open(
     Object::GameObject& parent, AssetRepository const&, std::string_view name,
-    std::function<void(Object::GameObject&, Engine::MeshBuilder&, ModelMetaData)> const& on_object);
+    std::function<void(Object::GameObject&, MeshLevels&, ModelMetaData)> const& on_object,
+    int level_count = 1);
 
 }
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "model_snapshot.hpp"
+#include "asset_repository.hpp"
+#include "engine/graphics/mesh/mesh_builder.hpp"
+#include "engine/graphics/texture/image_texture.hpp"
+#include <memory>
+#include <vector>
+using namespace Engine;
+
+template<typename T>
+static T read(std::istream& stream)
+{
+    T value {};
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+static std::string read_string(std::istream& stream)
+{
+    std::string string(read<uint32_t>(stream), '\0');
+    stream.read(string.data(), static_cast<std::streamsize>(string.size()));
+    return string;
+}
+
+static glm::vec3 read_vec3(std::istream& stream)
+{
+    auto x = read<float>(stream);
+    auto y = read<float>(stream);
+    auto z = read<float>(stream);
+    return { x, y, z };
+}
+
+template<typename T>
+static void read_array(std::istream& stream, std::vector<T>& array)
+{
+    array.resize(read<uint32_t>(stream));
+    stream.read(reinterpret_cast<char*>(array.data()), static_cast<std::streamsize>(array.size() * sizeof(T)));
+}
+
+static std::shared_ptr<Texture> texture_at(std::vector<std::shared_ptr<Texture>> const& textures, int32_t index)
+{
+    if (index < 0 || index >= static_cast<int32_t>(textures.size())) {
+        return nullptr;
+    }
+
+    return textures[index];
+}
+
+std::string ModelSnapshot::name_for(std::string_view model_name)
+{
+    auto extension = model_name.rfind('.');
+    return std::string(model_name.substr(0, extension)) + ".snapshot";
+}
+
+bool ModelSnapshot::read_mesh(std::istream& stream, MeshBuilder& builder)
+{
+    read_array(stream, builder.m_vertices);
+    read_array(stream, builder.m_normals);
+    read_array(stream, builder.m_tangents);
+    read_array(stream, builder.m_bitangents);
+    read_array(stream, builder.m_uv01);
+    read_array(stream, builder.m_indicies);
+    return stream.good();
+}
+
+bool ModelSnapshot::for_each_node(AssetRepository const& assets, std::string_view name, ColladaLoader::OnNode const& on_node, int level_count)
+{
+    auto stream = assets.open(name);
+    if (!stream) {
+        return false;
+    }
+
+    if (read<uint32_t>(*stream) != magic || read<uint32_t>(*stream) != version) {
+        std::cerr << "Error: '" << name << "' is not a version " << version << " model snapshot\n";
+        return false;
+    }
+
+    std::vector<std::shared_ptr<Texture>> textures(read<uint32_t>(*stream));
+    for (auto& texture : textures) {
+        texture = ImageTexture::construct(assets, read_string(*stream));
+    }
+
+    std::vector<Material> materials(read<uint32_t>(*stream));
+    for (auto& material : materials) {
+        material.name = read_string(*stream);
+        material.color = read_vec3(*stream);
+        material.specular_color = read_vec3(*stream);
+        material.emission_color = read_vec3(*stream);
+        material.normal_map_strength = read<float>(*stream);
+        material.specular_focus = read<float>(*stream);
+        material.metallic = read<float>(*stream);
+        material.diffuse_map = texture_at(textures, read<int32_t>(*stream));
+        material.normal_map = texture_at(textures, read<int32_t>(*stream));
+        material.light_map = texture_at(textures, read<int32_t>(*stream));
+    }
+
+    // Already welded and reordered when baked, so ready to build as is.
+    // Each mesh has its LOD levels baked after it, only as many as were
+    // asked for are kept.
+    std::vector<ColladaLoader::MeshLevels> meshes(read<uint32_t>(*stream));
+    for (auto& levels : meshes) {
+        levels.resize(read<uint32_t>(*stream));
+        if (levels.empty()) {
+            std::cerr << "Error: Mesh without any levels in model snapshot '" << name << "'\n";
+            return false;
+        }
+
+        for (auto& mesh : levels) {
+            if (!read_mesh(*stream, mesh)) {
+                std::cerr << "Error: Truncated mesh in model snapshot '" << name << "'\n";
+                return false;
+            }
+        }
+
+        if (levels.size() > size_t(level_count)) {
+            levels.resize(level_count);
+        }
+    }
+
+    // Every node is checked before any are called back, so a bad snapshot
+    // leaves nothing behind and the caller can fall back to the Collada
+    // model
+    struct Node {
+        std::string name;
+        uint32_t mesh_index;
+        uint32_t material_index;
+        glm::vec3 translation;
+        glm::vec3 scale;
+        glm::vec3 rotation;
+    };
+
+    std::vector<Node> nodes(read<uint32_t>(*stream));
+    for (auto& node : nodes) {
+        node.name = read_string(*stream);
+        node.mesh_index = read<uint32_t>(*stream);
+        node.material_index = read<uint32_t>(*stream);
+        node.translation = read_vec3(*stream);
+        node.scale = read_vec3(*stream);
+        node.rotation = read_vec3(*stream);
+        if (!stream->good() || node.mesh_index >= meshes.size() || node.material_index >= materials.size()) {
+            std::cerr << "Error: Invalid node in model snapshot '" << name << "'\n";
+            return false;
+        }
+    }
+
+    for (auto& node : nodes) {
+        on_node(meshes[node.mesh_index], ColladaLoader::ModelMetaData {
+                                             .name = std::move(node.name),
+                                             .material = materials[node.material_index],
+                                             .translation = node.translation,
+                                             .scale = node.scale,
+                                             .rotation = node.rotation,
+                                         });
+    }
+
+    return true;
+}
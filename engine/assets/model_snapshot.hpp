@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "collada_loader.hpp"
+#include "engine/forward.hpp"
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+
+namespace Engine {
+
+// A Collada model baked by tools/snapshot_generator.py into flat binary
+// tables, so loading skips XML parsing, tangent generation and mesh
+// optimisation, meshes are stored already welded and reordered, along with
+// their LOD levels. Textures,
+// materials and meshes are stored once and referenced by index from each
+// node. Every array is read with a single call straight into its final
+// storage.
+class ModelSnapshot {
+public:
+    static constexpr uint32_t magic = 0x504e5342; // "BSNP"
+    static constexpr uint32_t version = 3;
+
+    // The snapshot baked from a model, e.g. "/models/bumper.snapshot"
+    static std::string name_for(std::string_view model_name);
+
+    // Gives at most level_count levels per mesh, fewer if fewer were baked.
+    // Returns false, having called nothing, if the snapshot's missing or bad
+    static bool for_each_node(AssetRepository const&, std::string_view name, ColladaLoader::OnNode const& on_node, int level_count = 1);
+
+private:
+    static bool read_mesh(std::istream&, MeshBuilder&);
+};
+
+}
@@ -5,9 +5,9 @@
  */
 
 #include "thread_pool.hpp"
-#include <chrono>
 #include <cstdlib>
 #include <functional>
+#include <utility>
 #include <vector>
 using namespace Engine;
 
@@ -22,8 +22,11 @@ static std::function<void()> on_tasks_finished_callback;
 
 static int on_animation_request_loop(double, void*)
 {
-    if (s_task_queue.empty())
+    // Stopped, so queuing another task starts it again
+    if (s_task_queue.empty()) {
+        s_on_animation_request_loop_started = false;
         return false;
+    }
 
     auto task = s_task_queue.back();
     s_task_queue.pop_back();
@@ -31,7 +34,7 @@ static int on_animation_request_loop(double, void*)
     task();
 
     if (s_task_queue.empty() && on_tasks_finished_callback)
-        on_tasks_finished_callback();
+        std::exchange(on_tasks_finished_callback, nullptr)();
     return true;
 }
 
@@ -54,14 +57,22 @@ void ThreadPool::finished_loading()
 {
 }
 
+void ThreadPool::run_parallel(std::vector<std::function<void()>> const& jobs)
+{
+    for (auto const& job : jobs) {
+        job();
+    }
+}
+
 #else
 
 #ifdef WIN32
 
 #include <Windows.h>
+#include <climits>
 
 static HANDLE s_task_queue_mutex;
-static HANDLE s_should_shutdown_mutex;
+static HANDLE s_tasks_available;
 static std::vector<HANDLE> s_threads;
 
 class WindowsMutexGuard {
@@ -86,11 +97,14 @@ private:
 
 #else
 
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
 static std::mutex s_task_queue_mutex;
-static std::mutex s_should_shutdown_mutex;
+static std::condition_variable s_task_available;
 static std::vector<std::thread> s_threads;
 
 #define MUTEX_GUARD(_mutex) \
@@ -99,19 +113,30 @@ static std::vector<std::thread> s_threads;
 #endif
 
 constexpr int THREAD_COUNT = 4;
-constexpr int TIMEOUT = 100;
 
+// Both guarded by the task queue mutex
 static std::vector<std::function<void()>> s_task_queue;
 static bool s_should_shutdown = false;
-static bool s_shutdown_on_completed = false;
+
 static bool s_has_threads_started { false };
 
 static std::function<void()> on_tasks_finished_callback;
 
-static std::function<void()> next_task()
+// Blocks until there's a task, or returns nothing once shutting down.
+// Workers stay alive after loading, so streamed textures queued later
+// are picked up straight away, without polling or respawning threads.
+static std::function<void()> wait_for_task()
 {
+#ifdef WIN32
+    // The semaphore counts queued tasks, plus one per thread on shutdown
+    WaitForSingleObject(s_tasks_available, INFINITE);
     MUTEX_GUARD(s_task_queue_mutex);
-    if (s_task_queue.empty()) {
+#else
+    std::unique_lock<std::mutex> guard(s_task_queue_mutex);
+    s_task_available.wait(guard, [] { return s_should_shutdown || !s_task_queue.empty(); });
+#endif
+
+    if (s_should_shutdown || s_task_queue.empty()) {
         return {};
     }
 
@@ -120,6 +145,15 @@ static std::function<void()> next_task()
     return task;
 }
 
+static void notify_task_available()
+{
+#ifdef WIN32
+    ReleaseSemaphore(s_tasks_available, 1, NULL);
+#else
+    s_task_available.notify_one();
+#endif
+}
+
 #ifdef WIN32
 static DWORD WINAPI worker_thread(__in LPVOID)
 #else
@@ -127,38 +161,25 @@ static void worker_thread()
 #endif
 {
     for (;;) {
-        bool shutdown_on_completed;
-
-        {
-            MUTEX_GUARD(s_should_shutdown_mutex);
-            if (s_should_shutdown) {
-                break;
-            }
-            shutdown_on_completed = s_shutdown_on_completed;
-        }
-
-        auto task = next_task();
+        auto task = wait_for_task();
         if (!task) {
-            if (shutdown_on_completed) {
-                break;
-            }
-
-#ifdef WIN32
-            Sleep(TIMEOUT);
-#else
-            std::this_thread::sleep_for(std::chrono::milliseconds(TIMEOUT));
-#endif
-            continue;
+            break;
         }
 
         task();
 
-        if (on_tasks_finished_callback) {
+        // Only once, tasks queued afterwards don't finish loading again
+        std::function<void()> on_tasks_finished;
+        {
             MUTEX_GUARD(s_task_queue_mutex);
             if (s_task_queue.empty()) {
-                on_tasks_finished_callback();
+                on_tasks_finished = std::exchange(on_tasks_finished_callback, nullptr);
             }
         }
+
+        if (on_tasks_finished) {
+            on_tasks_finished();
+        }
     }
 
 #ifdef WIN32
@@ -173,19 +194,21 @@ static void shutdown()
     }
 
     {
-        MUTEX_GUARD(s_should_shutdown_mutex);
+        MUTEX_GUARD(s_task_queue_mutex);
         s_should_shutdown = true;
     }
 
 #ifdef WIN32
-    CloseHandle(s_task_queue_mutex);
-    CloseHandle(s_should_shutdown_mutex);
-
+    ReleaseSemaphore(s_tasks_available, THREAD_COUNT, NULL);
     for (auto& thread : s_threads) {
         WaitForSingleObject(thread, INFINITE);
         CloseHandle(thread);
     }
+
+    CloseHandle(s_task_queue_mutex);
+    CloseHandle(s_tasks_available);
 #else
+    s_task_available.notify_all();
     for (auto& thread : s_threads) {
         thread.join();
     }
@@ -194,7 +217,6 @@ static void shutdown()
     s_threads.clear();
     s_has_threads_started = false;
     s_should_shutdown = false;
-    s_shutdown_on_completed = false;
 }
 
 static void start_threads_if_needed()
@@ -203,14 +225,9 @@ static void start_threads_if_needed()
         return;
     }
 
-#if defined(WEBASSEMBLY)
-
-    // No threading support
-
-#elif defined(WIN32)
+#ifdef WIN32
     s_task_queue_mutex = CreateMutex(NULL, FALSE, NULL);
-    s_should_shutdown_mutex = CreateMutex(NULL, FALSE, NULL);
-
+    s_tasks_available = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
     for (int i = 0; i < THREAD_COUNT; i++) {
         s_threads.push_back(CreateThread(0, 0, worker_thread, 0, 0, NULL));
     }
@@ -228,19 +245,135 @@ void ThreadPool::queue_task(std::function<void()> const& task)
 {
     start_threads_if_needed();
 
-    MUTEX_GUARD(s_task_queue_mutex);
-    s_task_queue.insert(s_task_queue.begin(), task);
+    {
+        MUTEX_GUARD(s_task_queue_mutex);
+        s_task_queue.insert(s_task_queue.begin(), task);
+    }
+
+    notify_task_available();
 }
 
 void ThreadPool::on_tasks_finished(std::function<void()> const& callback)
 {
+    start_threads_if_needed();
+
+    MUTEX_GUARD(s_task_queue_mutex);
     on_tasks_finished_callback = callback;
 }
 
+// Idle workers wait without using any time, so they're kept for streaming
 void ThreadPool::finished_loading()
 {
-    MUTEX_GUARD(s_should_shutdown_mutex);
-    s_shutdown_on_completed = true;
 }
 
+#ifdef WIN32
+
+void ThreadPool::run_parallel(std::vector<std::function<void()>> const& jobs)
+{
+    for (auto const& job : jobs) {
+        job();
+    }
+}
+
+#else
+
+// Jobs are run every frame and the caller waits on them, so they get
+// their own workers rather than queuing behind loading tasks.
+static std::mutex s_job_mutex;
+static std::condition_variable s_job_available;
+static std::condition_variable s_jobs_finished;
+static std::vector<std::thread> s_job_threads;
+static std::vector<std::function<void()>> const* s_jobs { nullptr };
+static size_t s_next_job { 0 };
+static size_t s_jobs_remaining { 0 };
+static bool s_should_stop_jobs { false };
+
+static bool has_next_job()
+{
+    return s_jobs && s_next_job < s_jobs->size();
+}
+
+static void run_next_job(std::unique_lock<std::mutex>& lock)
+{
+    auto const& job = (*s_jobs)[s_next_job++];
+    lock.unlock();
+    job();
+    lock.lock();
+
+    s_jobs_remaining -= 1;
+    if (s_jobs_remaining == 0) {
+        s_jobs_finished.notify_all();
+    }
+}
+
+static void job_thread()
+{
+    std::unique_lock<std::mutex> lock(s_job_mutex);
+    for (;;) {
+        s_job_available.wait(lock, [] { return s_should_stop_jobs || has_next_job(); });
+        if (s_should_stop_jobs) {
+            break;
+        }
+
+        run_next_job(lock);
+    }
+}
+
+static void stop_job_threads()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_job_mutex);
+        s_should_stop_jobs = true;
+    }
+
+    s_job_available.notify_all();
+    for (auto& thread : s_job_threads) {
+        thread.join();
+    }
+    s_job_threads.clear();
+}
+
+static void start_job_threads_if_needed()
+{
+    if (!s_job_threads.empty()) {
+        return;
+    }
+
+    // The calling thread takes jobs too
+    auto thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    for (unsigned i = 0; i < thread_count; i++) {
+        s_job_threads.push_back(std::thread(job_thread));
+    }
+
+    std::atexit(stop_job_threads);
+}
+
+void ThreadPool::run_parallel(std::vector<std::function<void()>> const& jobs)
+{
+    if (jobs.size() <= 1) {
+        for (auto const& job : jobs) {
+            job();
+        }
+        return;
+    }
+
+    start_job_threads_if_needed();
+
+    std::unique_lock<std::mutex> lock(s_job_mutex);
+    assert(!s_jobs);
+    s_jobs = &jobs;
+    s_next_job = 0;
+    s_jobs_remaining = jobs.size();
+    s_job_available.notify_all();
+
+    while (has_next_job()) {
+        run_next_job(lock);
+    }
+
+    s_jobs_finished.wait(lock, [] { return s_jobs_remaining == 0; });
+    s_jobs = nullptr;
+}
+
+#endif
+
 #endif
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 namespace Engine::ThreadPool {
 
@@ -15,4 +16,8 @@ void finished_loading();
 
 void on_tasks_finished(std::function<void()> const&);
 
+// Runs every job across the worker threads and the calling thread,
+// returning once they've all finished.
+void run_parallel(std::vector<std::function<void()>> const& jobs);
+
 }
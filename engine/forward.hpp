@@ -10,12 +10,18 @@ namespace Engine {
 
 class AssetRepository;
 class MeshBuilder;
+class MeshOptimizer;
+class MeshSimplifier;
+class ModelSnapshot;
 class Mesh;
+struct Material;
 class DynamicData;
 class Texture;
 class ImageTexture;
+class CompressedImage;
 class RenderTexture;
 class Shader;
+class UniformBuffer;
 class Renderer;
 class StandardRenderer;
 class SkyBoxRenderer;
@@ -24,6 +24,20 @@ struct Material {
     std::shared_ptr<Texture> diffuse_map;
     std::shared_ptr<Texture> normal_map;
     std::shared_ptr<Texture> light_map;
+
+    // Whether the two draw the same, regardless of name
+    bool operator==(Material const& other) const
+    {
+        return color == other.color
+            && specular_color == other.specular_color
+            && emission_color == other.emission_color
+            && normal_map_strength == other.normal_map_strength
+            && specular_focus == other.specular_focus
+            && metallic == other.metallic
+            && diffuse_map == other.diffuse_map
+            && normal_map == other.normal_map
+            && light_map == other.light_map;
+    }
 };
 
 }
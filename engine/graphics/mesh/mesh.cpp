@@ -8,11 +8,6 @@
 #include "mesh_builder.hpp"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
-
-#ifdef WEBASSEMBLY
-#include <iostream>
-#endif
-
 using namespace Engine;
 
 std::shared_ptr<Mesh> Mesh::construct(MeshBuilder const& builder)
@@ -21,31 +16,15 @@ std::shared_ptr<Mesh> Mesh::construct(MeshBuilder const& builder)
     glGenVertexArrays(1, &mesh->m_vao);
     glBindVertexArray(mesh->m_vao);
 
-    glGenBuffers(mesh->m_vbo.size(), mesh->m_vbo.data());
+    glGenBuffers(1, &mesh->m_vertex_buffer);
+    glGenBuffers(1, &mesh->m_index_buffer);
 
-    int index = 0;
-    if (!builder.m_vertices.empty()) {
-        mesh->bind_buffer_data<3, GL_FLOAT>(index++, builder.m_vertices);
-    }
-    if (!builder.m_normals.empty()) {
-        mesh->bind_buffer_data<3, GL_FLOAT>(index++, builder.m_normals);
-    }
-    if (!builder.m_uv01.empty()) {
-        mesh->bind_buffer_data<4, GL_FLOAT>(index++, builder.m_uv01);
-    }
-    if (!builder.m_cube_texture_coords.empty()) {
-        mesh->bind_buffer_data<3, GL_FLOAT>(index++, builder.m_cube_texture_coords);
-    }
-    if (!builder.m_tangents.empty()) {
-        mesh->bind_buffer_data<3, GL_FLOAT>(index++, builder.m_tangents);
-    }
-    if (!builder.m_bitangents.empty()) {
-        mesh->bind_buffer_data<3, GL_FLOAT>(index++, builder.m_bitangents);
-    }
-    mesh->bind_indicies(index++, builder.m_indicies);
+    auto layout = builder.layout();
+    mesh->bind_vertices(layout, builder.pack_vertices(layout));
+    mesh->bind_indicies(builder.m_indicies);
 
     if (builder.m_is_instanced) {
-        for (int i = 0; i < index; i++) {
+        for (int i = 0; i < static_cast<int>(layout.attributes().size()); i++) {
             glVertexAttribDivisor(i, 0);
         }
         mesh->m_instance_count = builder.m_instance_count;
@@ -53,55 +32,84 @@ std::shared_ptr<Mesh> Mesh::construct(MeshBuilder const& builder)
 
     glBindVertexArray(0);
     mesh->m_count = builder.m_indicies.size();
+    mesh->m_bounds = builder.bounds();
+    mesh->m_uv_density = builder.uv_density();
     return mesh;
 }
 
-static void vertex_attrib_pointer(int index, GLuint data_type, int size)
+static void vertex_attrib_pointer(int index, VertexLayout::Format format, GLsizei stride, size_t offset)
 {
-    switch (data_type) {
-    case GL_FLOAT:
-        glVertexAttribPointer(index, size, data_type, GL_FALSE, 0, 0);
+    auto const* pointer = reinterpret_cast<void const*>(offset);
+    switch (format) {
+    case VertexLayout::Format::Float3:
+        glVertexAttribPointer(index, 3, GL_FLOAT, GL_FALSE, stride, pointer);
+        break;
+    case VertexLayout::Format::OctahedralNormal:
+        glVertexAttribPointer(index, 2, GL_SHORT, GL_TRUE, stride, pointer);
+        break;
+    case VertexLayout::Format::PackedTangent:
+        glVertexAttribPointer(index, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, pointer);
         break;
-    case GL_INT:
-#ifdef WEBASSEMBLY
-        std::cerr << "Int vertex attributes not supported on webassembly\n";
-        assert(false);
-#else
-        glVertexAttribIPointer(index, size, data_type, 0, 0);
-#endif
+    case VertexLayout::Format::Half4:
+        glVertexAttribPointer(index, 4, GL_HALF_FLOAT, GL_FALSE, stride, pointer);
         break;
     }
 }
 
-template<int size, GLuint gl_type, typename T>
-void Mesh::bind_buffer_data(int index, std::vector<T> data)
+void Mesh::bind_vertices(VertexLayout const& layout, std::vector<uint8_t> const& data)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo[index]);
-    glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(T), data.data(), GL_STATIC_DRAW);
-    vertex_attrib_pointer(index, gl_type, size);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+
+    auto const& attributes = layout.attributes();
+    for (int index = 0; index < static_cast<int>(attributes.size()); index++) {
+        vertex_attrib_pointer(index, attributes[index].format, layout.stride(), attributes[index].offset);
+        glEnableVertexAttribArray(index);
+    }
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glEnableVertexAttribArray(index);
 }
 
-void Mesh::bind_indicies(int index, std::vector<uint32_t> indicies)
+void Mesh::bind_indicies(std::vector<uint32_t> const& indicies)
 {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_vbo[index]);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicies.size() * sizeof(uint32_t), indicies.data(), GL_STATIC_DRAW);
 }
 
 void Mesh::draw() const
+{
+    bind();
+    draw_bound();
+    unbind();
+}
+
+void Mesh::bind() const
 {
     glBindVertexArray(m_vao);
+}
+
+void Mesh::draw_bound() const
+{
     if (m_instance_count > 0) {
         glDrawElementsInstanced(GL_TRIANGLES, m_count, GL_UNSIGNED_INT, nullptr, m_instance_count);
     } else {
         glDrawElements(GL_TRIANGLES, m_count, GL_UNSIGNED_INT, nullptr);
     }
+}
+
+void Mesh::draw_instanced(int count) const
+{
+    glDrawElementsInstanced(GL_TRIANGLES, m_count, GL_UNSIGNED_INT, nullptr, count);
+}
+
+void Mesh::unbind()
+{
     glBindVertexArray(0);
 }
 
 Mesh::~Mesh()
 {
-    glDeleteBuffers(m_vbo.size(), m_vbo.data());
+    glDeleteBuffers(1, &m_vertex_buffer);
+    glDeleteBuffers(1, &m_index_buffer);
     glDeleteVertexArrays(1, &m_vao);
 }
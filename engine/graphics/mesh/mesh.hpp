@@ -7,7 +7,8 @@
 #pragma once
 
 #include "engine/forward.hpp"
-#include <array>
+#include "engine/graphics/mesh/vertex_layout.hpp"
+#include "engine/math/aabb.hpp"
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
@@ -25,16 +26,30 @@ public:
 
     void draw() const;
 
+    // For drawing the same mesh several times without rebinding it
+    void bind() const;
+    void draw_bound() const;
+    void draw_instanced(int count) const;
+    static void unbind();
+
+    [[nodiscard]] inline GLuint id() const { return m_vao; }
+
+    // In model space, worked out when built
+    [[nodiscard]] inline AABB const& bounds() const { return m_bounds; }
+    [[nodiscard]] inline float uv_density() const { return m_uv_density; }
+
 private:
     Mesh() = default;
 
-    template<int size, GLuint gl_type, typename T>
-    void bind_buffer_data(int index, std::vector<T> data);
-    void bind_indicies(int index, std::vector<uint32_t>);
+    void bind_vertices(VertexLayout const&, std::vector<uint8_t> const& data);
+    void bind_indicies(std::vector<uint32_t> const&);
 
     GLuint m_vao;
-    std::array<GLuint, 7> m_vbo;
+    GLuint m_vertex_buffer;
+    GLuint m_index_buffer;
     int m_count { 0 };
+    AABB m_bounds;
+    float m_uv_density { 0 };
     int m_instance_count { 0 };
 };
 
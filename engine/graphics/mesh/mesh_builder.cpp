@@ -6,6 +6,10 @@
 
 #include "mesh_builder.hpp"
 #include "mesh.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
 using namespace Engine;
 
 MeshBuilder& MeshBuilder::add_vertex(glm::vec3 position)
@@ -83,6 +87,38 @@ MeshBuilder& MeshBuilder::add_builder(MeshBuilder const& other)
     return *this;
 }
 
+static void append_transformed(std::vector<float>& to, std::vector<float> const& from, glm::mat3 const& transform)
+{
+    for (size_t i = 0; i + 2 < from.size(); i += 3) {
+        auto vector = glm::normalize(transform * glm::vec3(from[i + 0], from[i + 1], from[i + 2]));
+        to.insert(to.end(), { vector.x, vector.y, vector.z });
+    }
+}
+
+MeshBuilder& MeshBuilder::add_transformed(MeshBuilder const& other, glm::mat4 const& transform)
+{
+    auto first_index = static_cast<uint32_t>(vertex_count());
+    for (auto index : other.m_indicies) {
+        m_indicies.push_back(index + first_index);
+    }
+
+    for (size_t i = 0; i + 2 < other.m_vertices.size(); i += 3) {
+        auto position = transform * glm::vec4(other.m_vertices[i + 0], other.m_vertices[i + 1], other.m_vertices[i + 2], 1);
+        m_vertices.insert(m_vertices.end(), { position.x, position.y, position.z });
+    }
+
+    // Normals need the inverse transpose to stay perpendicular under a
+    // non-uniform scale, tangents follow the surface
+    auto linear = glm::mat3(transform);
+    append_transformed(m_normals, other.m_normals, glm::transpose(glm::inverse(linear)));
+    append_transformed(m_tangents, other.m_tangents, linear);
+    append_transformed(m_bitangents, other.m_bitangents, linear);
+
+    m_uv01.insert(m_uv01.end(), other.m_uv01.begin(), other.m_uv01.end());
+    m_cube_texture_coords.insert(m_cube_texture_coords.end(), other.m_cube_texture_coords.begin(), other.m_cube_texture_coords.end());
+    return *this;
+}
+
 MeshBuilder& MeshBuilder::add_quad(glm::vec2 size, bool is_y_flipped)
 {
     add_vertex(glm::vec3(-size.x, -size.y, 0.0f)).add_uv0(glm::vec2(0, is_y_flipped ? 1 : 0));
@@ -159,6 +195,173 @@ bool MeshBuilder::is_empty() const
     return m_indicies.empty();
 }
 
+AABB MeshBuilder::bounds() const
+{
+    AABB bounds;
+    for (size_t i = 0; i + 2 < m_vertices.size(); i += 3) {
+        bounds.extend(glm::vec3(m_vertices[i + 0], m_vertices[i + 1], m_vertices[i + 2]));
+    }
+
+    return bounds;
+}
+
+float MeshBuilder::uv_density() const
+{
+    if (m_uv01.empty()) {
+        return 0;
+    }
+
+    float uv_area = 0;
+    float surface_area = 0;
+    for (size_t i = 0; i + 2 < m_indicies.size(); i += 3) {
+        auto position = [&](int corner) {
+            auto vertex = m_indicies[i + corner] * 3;
+            return glm::vec3(m_vertices[vertex + 0], m_vertices[vertex + 1], m_vertices[vertex + 2]);
+        };
+
+        auto uv = [&](int corner) {
+            auto vertex = m_indicies[i + corner] * 4;
+            return glm::vec2(m_uv01[vertex + 0], m_uv01[vertex + 1]);
+        };
+
+        auto uv_edge_a = uv(1) - uv(0);
+        auto uv_edge_b = uv(2) - uv(0);
+        uv_area += std::abs(uv_edge_a.x * uv_edge_b.y - uv_edge_a.y * uv_edge_b.x) * 0.5f;
+        surface_area += glm::length(glm::cross(position(1) - position(0), position(2) - position(0))) * 0.5f;
+    }
+
+    return surface_area > 0 ? uv_area / surface_area : 0;
+}
+
+VertexLayout MeshBuilder::layout() const
+{
+    // Locations follow the order shaders declare their inputs in
+    VertexLayout layout;
+    layout.add(VertexLayout::Format::Float3);
+    if (!m_normals.empty()) {
+        layout.add(VertexLayout::Format::OctahedralNormal);
+    }
+    if (!m_uv01.empty()) {
+        layout.add(VertexLayout::Format::Half4);
+    }
+    if (!m_cube_texture_coords.empty()) {
+        layout.add(VertexLayout::Format::Float3);
+    }
+    if (!m_tangents.empty()) {
+        layout.add(VertexLayout::Format::PackedTangent);
+    }
+
+    return layout;
+}
+
+static glm::vec3 vec3_at(std::vector<float> const& stream, int vertex)
+{
+    return glm::vec3(stream[vertex * 3 + 0], stream[vertex * 3 + 1], stream[vertex * 3 + 2]);
+}
+
+static glm::vec3 safe_normalize(glm::vec3 vector)
+{
+    auto length = glm::length(vector);
+    if (!(length > 0.0f) || !std::isfinite(length)) {
+        return glm::vec3(1, 0, 0);
+    }
+
+    return vector / length;
+}
+
+static int16_t snorm16(float value)
+{
+    return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+static uint32_t snorm10(float value)
+{
+    return static_cast<uint32_t>(static_cast<int32_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 511.0f))) & 0x3ff;
+}
+
+static void write_octahedral(uint8_t* to, glm::vec3 normal)
+{
+    normal = safe_normalize(normal);
+    auto folded = glm::vec2(normal) / (std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z));
+    if (normal.z < 0) {
+        // The lower half folds out over the corners
+        folded = glm::vec2(
+            (1.0f - std::abs(folded.y)) * (folded.x >= 0 ? 1.0f : -1.0f),
+            (1.0f - std::abs(folded.x)) * (folded.y >= 0 ? 1.0f : -1.0f));
+    }
+
+    int16_t const encoded[2] = { snorm16(folded.x), snorm16(folded.y) };
+    std::memcpy(to, encoded, sizeof(encoded));
+}
+
+static void write_tangent(uint8_t* to, glm::vec3 normal, glm::vec3 tangent, glm::vec3 bitangent)
+{
+    tangent = safe_normalize(tangent);
+    auto handedness = glm::dot(glm::cross(normal, tangent), bitangent) < 0 ? 3u : 1u;
+    uint32_t const packed = snorm10(tangent.x)
+        | (snorm10(tangent.y) << 10)
+        | (snorm10(tangent.z) << 20)
+        | (handedness << 30);
+    std::memcpy(to, &packed, sizeof(packed));
+}
+
+std::vector<uint8_t> MeshBuilder::pack_vertices(VertexLayout const& layout) const
+{
+    std::vector<uint8_t> data(layout.stride() * vertex_count());
+    for (int vertex = 0; vertex < vertex_count(); vertex++) {
+        auto* to = data.data() + vertex * layout.stride();
+
+        // Attributes are in the order layout() added them
+        auto attribute = layout.attributes().begin();
+        auto next = [&]() { return to + (attribute++)->offset; };
+
+        auto position = vec3_at(m_vertices, vertex);
+        std::memcpy(next(), &position, sizeof(position));
+
+        auto normal = m_normals.empty() ? glm::vec3(0, 0, 1) : safe_normalize(vec3_at(m_normals, vertex));
+        if (!m_normals.empty()) {
+            write_octahedral(next(), normal);
+        }
+
+        if (!m_uv01.empty()) {
+            uint16_t const uv01[4] = {
+                glm::packHalf1x16(m_uv01[vertex * 4 + 0]),
+                glm::packHalf1x16(m_uv01[vertex * 4 + 1]),
+                glm::packHalf1x16(m_uv01[vertex * 4 + 2]),
+                glm::packHalf1x16(m_uv01[vertex * 4 + 3]),
+            };
+            std::memcpy(next(), uv01, sizeof(uv01));
+        }
+
+        if (!m_cube_texture_coords.empty()) {
+            auto texture_coord = vec3_at(m_cube_texture_coords, vertex);
+            std::memcpy(next(), &texture_coord, sizeof(texture_coord));
+        }
+
+        if (!m_tangents.empty()) {
+            auto bitangent = m_bitangents.empty() ? glm::cross(normal, vec3_at(m_tangents, vertex)) : vec3_at(m_bitangents, vertex);
+            write_tangent(next(), normal, vec3_at(m_tangents, vertex), bitangent);
+        }
+    }
+
+    return data;
+}
+
+bool MeshBuilder::has_same_layout(MeshBuilder const& other) const
+{
+    // An empty builder takes on the layout of whatever's added first
+    if (is_empty() || other.is_empty()) {
+        return true;
+    }
+
+    return m_normals.empty() == other.m_normals.empty()
+        && m_tangents.empty() == other.m_tangents.empty()
+        && m_bitangents.empty() == other.m_bitangents.empty()
+        && m_uv01.empty() == other.m_uv01.empty()
+        && m_cube_texture_coords.empty() == other.m_cube_texture_coords.empty()
+        && m_is_instanced == other.m_is_instanced;
+}
+
 std::shared_ptr<Mesh> MeshBuilder::build() const
 {
     return Mesh::construct(*this);
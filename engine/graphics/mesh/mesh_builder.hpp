@@ -7,6 +7,8 @@
 #pragma once
 
 #include "engine/forward.hpp"
+#include "engine/graphics/mesh/vertex_layout.hpp"
+#include "engine/math/aabb.hpp"
 #include <array>
 #include <glm/glm.hpp>
 #include <memory>
@@ -16,6 +18,9 @@ namespace Engine {
 
 class MeshBuilder {
     friend Mesh;
+    friend ModelSnapshot;
+    friend MeshOptimizer;
+    friend MeshSimplifier;
 
 public:
     MeshBuilder() = default;
@@ -37,14 +42,34 @@ public:
     }
 
     MeshBuilder& add_builder(MeshBuilder const&);
+
+    // Appends every attribute of the other builder, moved by the transform
+    MeshBuilder& add_transformed(MeshBuilder const&, glm::mat4 const& transform);
     MeshBuilder& add_quad(glm::vec2 size, bool is_y_flipped);
     MeshBuilder& add_sky_box(float size);
     MeshBuilder& make_instanced(int count);
     bool is_empty() const;
 
+    // Both have the same set of attributes, so can be merged
+    bool has_same_layout(MeshBuilder const&) const;
+
     std::shared_ptr<Mesh> build() const;
 
     inline int vertex_count() const { return m_vertices.size() / 3; }
+    inline int triangle_count() const { return m_indicies.size() / 3; }
+    inline glm::vec3 vertex(int index) const { return { m_vertices[index * 3 + 0], m_vertices[index * 3 + 1], m_vertices[index * 3 + 2] }; }
+    inline std::vector<uint32_t> const& indicies() const { return m_indicies; }
+    AABB bounds() const;
+
+    // Area of the first UV set per unit of surface area, zero without UVs
+    float uv_density() const;
+
+    // The compact interleaved layout for the attributes this builder has.
+    // Tangents and bitangents share one attribute.
+    VertexLayout layout() const;
+
+    // Packs every vertex into the layout, one after another
+    std::vector<uint8_t> pack_vertices(VertexLayout const&) const;
 
 private:
     std::vector<float> m_vertices;
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "mesh_optimizer.hpp"
+#include "mesh_builder.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+using namespace Engine;
+
+namespace {
+
+struct Stream {
+    std::vector<float>* data;
+    size_t components;
+};
+
+// Every attribute a vertex could have, for welding
+struct VertexKey {
+    std::array<float, 13> values;
+
+    bool operator==(VertexKey const& other) const
+    {
+        return std::memcmp(values.data(), other.values.data(), sizeof(values)) == 0;
+    }
+};
+
+struct VertexKeyHash {
+    size_t operator()(VertexKey const& key) const
+    {
+        // FNV-1a over the raw bits, so equal keys always hash the same
+        uint64_t hash = 14695981039346656037ull;
+        auto const* bytes = reinterpret_cast<uint8_t const*>(key.values.data());
+        for (size_t i = 0; i < sizeof(key.values); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return static_cast<size_t>(hash);
+    }
+};
+
+}
+
+MeshOptimizer::Stats& MeshOptimizer::Stats::operator+=(Stats const& other)
+{
+    vertices_before += other.vertices_before;
+    vertices_after += other.vertices_after;
+    triangles += other.triangles;
+    cache_misses_before += other.cache_misses_before;
+    cache_misses_after += other.cache_misses_after;
+    return *this;
+}
+
+MeshOptimizer::Stats MeshOptimizer::optimize(MeshBuilder& builder)
+{
+    Stats stats;
+    stats.vertices_before = builder.vertex_count();
+    stats.triangles = builder.m_indicies.size() / 3;
+    stats.cache_misses_before = cache_misses(builder.m_indicies);
+
+    weld(builder);
+    builder.m_indicies = reorder_triangles(builder.m_indicies, builder.vertex_count());
+    reorder_vertices(builder);
+
+    stats.vertices_after = builder.vertex_count();
+    stats.cache_misses_after = cache_misses(builder.m_indicies);
+    return stats;
+}
+
+size_t MeshOptimizer::cache_misses(std::vector<uint32_t> const& indicies)
+{
+    std::deque<uint32_t> cache;
+    size_t misses = 0;
+    for (auto index : indicies) {
+        if (std::find(cache.begin(), cache.end(), index) != cache.end()) {
+            continue;
+        }
+
+        misses += 1;
+        cache.push_back(index);
+        if (cache.size() > cache_size) {
+            cache.pop_front();
+        }
+    }
+
+    return misses;
+}
+
+void MeshOptimizer::weld(MeshBuilder& builder)
+{
+    // Tangents are made per triangle, so aren't part of a vertex's
+    // identity. Welded vertices sum theirs, which smooths them.
+    std::array const keyed = {
+        Stream { &builder.m_vertices, 3 },
+        Stream { &builder.m_normals, 3 },
+        Stream { &builder.m_uv01, 4 },
+        Stream { &builder.m_cube_texture_coords, 3 },
+    };
+    std::array const summed = {
+        Stream { &builder.m_tangents, 3 },
+        Stream { &builder.m_bitangents, 3 },
+    };
+
+    auto vertex_count = static_cast<size_t>(builder.vertex_count());
+    std::unordered_map<VertexKey, uint32_t, VertexKeyHash> welded_indices;
+    welded_indices.reserve(vertex_count);
+
+    std::vector<uint32_t> remap(vertex_count);
+    std::array<std::vector<float>, keyed.size()> keyed_out;
+    std::array<std::vector<float>, summed.size()> summed_out;
+    uint32_t welded_count = 0;
+
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        VertexKey key {};
+        size_t offset = 0;
+        for (auto const& stream : keyed) {
+            if (!stream.data->empty()) {
+                std::memcpy(&key.values[offset], stream.data->data() + vertex * stream.components, stream.components * sizeof(float));
+            }
+            offset += stream.components;
+        }
+
+        auto [it, is_new] = welded_indices.emplace(key, welded_count);
+        remap[vertex] = it->second;
+        if (is_new) {
+            welded_count += 1;
+            for (size_t i = 0; i < keyed.size(); i++) {
+                auto const& stream = keyed[i];
+                if (!stream.data->empty()) {
+                    auto const* from = stream.data->data() + vertex * stream.components;
+                    keyed_out[i].insert(keyed_out[i].end(), from, from + stream.components);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < summed.size(); i++) {
+            auto const& stream = summed[i];
+            if (stream.data->empty()) {
+                continue;
+            }
+
+            auto& out = summed_out[i];
+            out.resize(welded_count * stream.components, 0.0f);
+            for (size_t component = 0; component < stream.components; component++) {
+                out[it->second * stream.components + component] += (*stream.data)[vertex * stream.components + component];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < keyed.size(); i++) {
+        *keyed[i].data = std::move(keyed_out[i]);
+    }
+    for (size_t i = 0; i < summed.size(); i++) {
+        *summed[i].data = std::move(summed_out[i]);
+    }
+    for (auto& index : builder.m_indicies) {
+        index = remap[index];
+    }
+}
+
+std::vector<uint32_t> MeshOptimizer::reorder_triangles(std::vector<uint32_t> const& indicies, size_t vertex_count)
+{
+    // Tipsify, Sander et al. 2007. Fans out around one vertex at a time,
+    // then moves on to whichever neighbour is most likely still cached.
+    auto triangle_count = indicies.size() / 3;
+
+    // Triangles using each vertex, as one flat array
+    std::vector<uint32_t> live(vertex_count, 0);
+    for (auto index : indicies) {
+        live[index] += 1;
+    }
+
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        offsets[vertex + 1] = offsets[vertex] + live[vertex];
+    }
+
+    std::vector<uint32_t> adjacency(indicies.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        for (size_t corner = 0; corner < 3; corner++) {
+            adjacency[fill[indicies[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+
+    std::vector<int64_t> cache_time(vertex_count, 0);
+    std::vector<bool> is_emitted(triangle_count, false);
+    std::vector<uint32_t> dead_end;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indicies.size());
+
+    int64_t time = cache_size + 1;
+    size_t cursor = 0;
+    int64_t fanning = vertex_count > 0 ? 0 : -1;
+    while (fanning >= 0) {
+        candidates.clear();
+        for (auto i = offsets[fanning]; i < offsets[fanning + 1]; i++) {
+            auto triangle = adjacency[i];
+            if (is_emitted[triangle]) {
+                continue;
+            }
+
+            for (size_t corner = 0; corner < 3; corner++) {
+                auto vertex = indicies[triangle * 3 + corner];
+                result.push_back(vertex);
+                dead_end.push_back(vertex);
+                candidates.push_back(vertex);
+                live[vertex] -= 1;
+                if (time - cache_time[vertex] > cache_size) {
+                    cache_time[vertex] = time;
+                    time += 1;
+                }
+            }
+            is_emitted[triangle] = true;
+        }
+
+        // Prefer the candidate that's in the cache and will stay there
+        // while its own fan is emitted
+        int64_t best = -1;
+        int64_t best_priority = -1;
+        for (auto vertex : candidates) {
+            if (live[vertex] == 0) {
+                continue;
+            }
+
+            int64_t priority = 0;
+            if (time - cache_time[vertex] + 2 * live[vertex] <= cache_size) {
+                priority = time - cache_time[vertex];
+            }
+            if (priority > best_priority) {
+                best = vertex;
+                best_priority = priority;
+            }
+        }
+
+        if (best < 0) {
+            // Back track through recently used vertices, then fall back
+            // to scanning for anything left
+            while (!dead_end.empty() && best < 0) {
+                auto vertex = dead_end.back();
+                dead_end.pop_back();
+                if (live[vertex] > 0) {
+                    best = vertex;
+                }
+            }
+
+            while (best < 0 && cursor < vertex_count) {
+                if (live[cursor] > 0) {
+                    best = cursor;
+                }
+                cursor += 1;
+            }
+        }
+
+        fanning = best;
+    }
+
+    return result;
+}
+
+void MeshOptimizer::reorder_vertices(MeshBuilder& builder)
+{
+    std::array const streams = {
+        Stream { &builder.m_vertices, 3 },
+        Stream { &builder.m_normals, 3 },
+        Stream { &builder.m_uv01, 4 },
+        Stream { &builder.m_cube_texture_coords, 3 },
+        Stream { &builder.m_tangents, 3 },
+        Stream { &builder.m_bitangents, 3 },
+    };
+
+    // Number vertices in the order the triangles first use them. Any not
+    // used at all are dropped.
+    auto constexpr unassigned = UINT32_MAX;
+    std::vector<uint32_t> remap(builder.vertex_count(), unassigned);
+    std::vector<uint32_t> order;
+    for (auto& index : builder.m_indicies) {
+        if (remap[index] == unassigned) {
+            remap[index] = order.size();
+            order.push_back(index);
+        }
+        index = remap[index];
+    }
+
+    for (auto const& stream : streams) {
+        if (stream.data->empty()) {
+            continue;
+        }
+
+        std::vector<float> reordered;
+        reordered.reserve(order.size() * stream.components);
+        for (auto vertex : order) {
+            auto const* from = stream.data->data() + vertex * stream.components;
+            reordered.insert(reordered.end(), from, from + stream.components);
+        }
+        *stream.data = std::move(reordered);
+    }
+}
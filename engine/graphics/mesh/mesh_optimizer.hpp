@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/forward.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+// Prepares loaded geometry for the GPU: merges duplicate vertices, orders
+// triangles so recently transformed vertices get reused from the
+// post-transform cache, then orders vertices by first use so fetches walk
+// the buffer forwards.
+class MeshOptimizer {
+public:
+    // Typical post-transform cache size on the hardware we target
+    static constexpr int cache_size = 16;
+
+    struct Stats {
+        size_t vertices_before { 0 };
+        size_t vertices_after { 0 };
+        size_t triangles { 0 };
+        size_t cache_misses_before { 0 };
+        size_t cache_misses_after { 0 };
+
+        // Average cache miss ratio, vertices transformed per triangle.
+        // Between 0.5 at best and 3 with no reuse.
+        [[nodiscard]] inline float acmr_before() const { return triangles ? float(cache_misses_before) / float(triangles) : 0; }
+        [[nodiscard]] inline float acmr_after() const { return triangles ? float(cache_misses_after) / float(triangles) : 0; }
+
+        Stats& operator+=(Stats const&);
+    };
+
+    static Stats optimize(MeshBuilder&);
+
+    // Against a FIFO cache of cache_size entries
+    static size_t cache_misses(std::vector<uint32_t> const& indicies);
+
+private:
+    static void weld(MeshBuilder&);
+    static std::vector<uint32_t> reorder_triangles(std::vector<uint32_t> const& indicies, size_t vertex_count);
+    static void reorder_vertices(MeshBuilder&);
+};
+
+}
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "mesh_simplifier.hpp"
+#include "mesh_builder.hpp"
+#include "mesh_optimizer.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <queue>
+#include <unordered_map>
+using namespace Engine;
+
+namespace {
+
+// Symmetric 4x4 matrix, summing the squared distance to a set of planes
+struct Quadric {
+    std::array<double, 10> values {};
+
+    static Quadric from_plane(glm::dvec3 normal, double d, double weight)
+    {
+        auto a = normal.x, b = normal.y, c = normal.z;
+        return Quadric { {
+            weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+            weight * b * b, weight * b * c, weight * b * d,
+            weight * c * c, weight * c * d,
+            weight * d * d,
+        } };
+    }
+
+    Quadric& operator+=(Quadric const& other)
+    {
+        for (size_t i = 0; i < values.size(); i++) {
+            values[i] += other.values[i];
+        }
+        return *this;
+    }
+
+    [[nodiscard]] double error(glm::dvec3 p) const
+    {
+        auto const& q = values;
+        return q[0] * p.x * p.x + 2 * q[1] * p.x * p.y + 2 * q[2] * p.x * p.z + 2 * q[3] * p.x
+            + q[4] * p.y * p.y + 2 * q[5] * p.y * p.z + 2 * q[6] * p.y
+            + q[7] * p.z * p.z + 2 * q[8] * p.z
+            + q[9];
+    }
+};
+
+// How far a triangle's normal may turn in one collapse, about 75 degrees
+constexpr double s_min_turn_cosine = 0.25;
+
+struct Collapse {
+    double cost;
+    uint32_t from;
+    uint32_t to;
+    uint32_t from_version;
+    uint32_t to_version;
+
+    bool operator>(Collapse const& other) const { return cost > other.cost; }
+};
+
+struct PositionHash {
+    size_t operator()(glm::vec3 const& position) const
+    {
+        uint32_t bits[3];
+        std::memcpy(bits, &position.x, sizeof(bits));
+        return (size_t(bits[0]) * 73856093) ^ (size_t(bits[1]) * 19349663) ^ (size_t(bits[2]) * 83492791);
+    }
+};
+
+}
+
+MeshBuilder MeshSimplifier::simplify(MeshBuilder const& builder, size_t target_triangles)
+{
+    auto const& indicies = builder.m_indicies;
+    auto vertex_count = static_cast<size_t>(builder.vertex_count());
+    auto triangle_count = indicies.size() / 3;
+
+    // Group vertices sharing a position, the collapse works on these
+    std::unordered_map<glm::vec3, uint32_t, PositionHash> position_ids;
+    std::vector<uint32_t> position_of(vertex_count);
+    std::vector<glm::dvec3> positions;
+    std::vector<std::vector<uint32_t>> wedges;
+    for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+        auto position = glm::vec3(builder.m_vertices[vertex * 3 + 0], builder.m_vertices[vertex * 3 + 1], builder.m_vertices[vertex * 3 + 2]);
+        auto [it, is_new] = position_ids.emplace(position, static_cast<uint32_t>(positions.size()));
+        if (is_new) {
+            positions.push_back(glm::dvec3(position));
+            wedges.emplace_back();
+        }
+        position_of[vertex] = it->second;
+        wedges[it->second].push_back(vertex);
+    }
+
+    auto position_count = positions.size();
+    std::vector<uint32_t> triangles(indicies.begin(), indicies.end());
+    std::vector<bool> is_triangle_removed(triangle_count, false);
+    std::vector<std::vector<uint32_t>> triangles_at(position_count);
+    std::vector<Quadric> quadrics(position_count);
+    std::map<std::pair<uint32_t, uint32_t>, int> edge_uses;
+
+    auto corner_position = [&](size_t triangle, int corner) {
+        return position_of[triangles[triangle * 3 + corner]];
+    };
+
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        std::array<uint32_t, 3> corners = { corner_position(triangle, 0), corner_position(triangle, 1), corner_position(triangle, 2) };
+        if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2]) {
+            is_triangle_removed[triangle] = true;
+            continue;
+        }
+
+        auto p0 = positions[corners[0]], p1 = positions[corners[1]], p2 = positions[corners[2]];
+        auto normal = glm::cross(p1 - p0, p2 - p0);
+        auto area = glm::length(normal);
+        if (area > 0) {
+            normal /= area;
+        }
+
+        // Weighted by area, so small triangles don't dominate
+        auto quadric = Quadric::from_plane(normal, -glm::dot(normal, p0), area);
+        for (int corner = 0; corner < 3; corner++) {
+            quadrics[corners[corner]] += quadric;
+            triangles_at[corners[corner]].push_back(triangle);
+
+            auto a = corners[corner], b = corners[(corner + 1) % 3];
+            edge_uses[{ std::min(a, b), std::max(a, b) }] += 1;
+        }
+    }
+
+    // Moving a vertex on an open border would eat into the silhouette
+    std::vector<bool> is_locked(position_count, false);
+    for (auto const& [edge, uses] : edge_uses) {
+        if (uses == 1) {
+            is_locked[edge.first] = true;
+            is_locked[edge.second] = true;
+        }
+    }
+
+    std::vector<uint32_t> versions(position_count, 0);
+    std::vector<bool> is_removed(position_count, false);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue;
+
+    auto push = [&](uint32_t from, uint32_t to) {
+        if (is_locked[from]) {
+            return;
+        }
+
+        auto quadric = quadrics[from];
+        quadric += quadrics[to];
+        queue.push(Collapse { quadric.error(positions[to]), from, to, versions[from], versions[to] });
+    };
+
+    for (auto const& [edge, uses] : edge_uses) {
+        push(edge.first, edge.second);
+        push(edge.second, edge.first);
+    }
+
+    // Collapsing mustn't turn any remaining triangle around u inside out
+    auto would_flip = [&](uint32_t from, uint32_t to) {
+        for (auto triangle : triangles_at[from]) {
+            if (is_triangle_removed[triangle]) {
+                continue;
+            }
+
+            std::array<glm::dvec3, 3> before, after;
+            bool has_to = false;
+            for (int corner = 0; corner < 3; corner++) {
+                auto position = corner_position(triangle, corner);
+                has_to |= position == to;
+                before[corner] = positions[position];
+                after[corner] = position == from ? positions[to] : positions[position];
+            }
+            if (has_to) {
+                continue;
+            }
+
+            // Folding up on edge is as bad as turning over, as it leaves a
+            // sliver standing across the surface
+            auto normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+            auto normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+            auto length_before = glm::length(normal_before);
+            auto length_after = glm::length(normal_after);
+            if (length_before == 0) {
+                continue;
+            }
+            if (length_after == 0 || glm::dot(normal_before, normal_after) <= s_min_turn_cosine * length_before * length_after) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    // The wedge at the new position most like the one being replaced, so
+    // normals and UVs stay as close as they can across seams
+    auto closest_wedge = [&](uint32_t vertex, uint32_t to) {
+        auto best = wedges[to].front();
+        auto best_distance = std::numeric_limits<float>::infinity();
+        for (auto candidate : wedges[to]) {
+            float distance = 0;
+            for (auto const* stream : { &builder.m_normals, &builder.m_uv01 }) {
+                auto components = stream == &builder.m_uv01 ? 4 : 3;
+                for (int i = 0; !stream->empty() && i < components; i++) {
+                    auto delta = (*stream)[vertex * components + i] - (*stream)[candidate * components + i];
+                    distance += delta * delta;
+                }
+            }
+
+            if (distance < best_distance) {
+                best = candidate;
+                best_distance = distance;
+            }
+        }
+
+        return best;
+    };
+
+    auto live_triangles = static_cast<size_t>(std::count(is_triangle_removed.begin(), is_triangle_removed.end(), false));
+    while (live_triangles > target_triangles && !queue.empty()) {
+        auto collapse = queue.top();
+        queue.pop();
+
+        auto from = collapse.from, to = collapse.to;
+        if (is_removed[from] || is_removed[to]) {
+            continue;
+        }
+        if (collapse.from_version != versions[from] || collapse.to_version != versions[to]) {
+            continue;
+        }
+        if (would_flip(from, to)) {
+            continue;
+        }
+
+        for (auto triangle : triangles_at[from]) {
+            if (is_triangle_removed[triangle]) {
+                continue;
+            }
+
+            bool has_to = false;
+            for (int corner = 0; corner < 3; corner++) {
+                has_to |= corner_position(triangle, corner) == to;
+            }
+            if (has_to) {
+                is_triangle_removed[triangle] = true;
+                live_triangles -= 1;
+                continue;
+            }
+
+            for (int corner = 0; corner < 3; corner++) {
+                auto& vertex = triangles[triangle * 3 + corner];
+                if (position_of[vertex] == from) {
+                    vertex = closest_wedge(vertex, to);
+                }
+            }
+            triangles_at[to].push_back(triangle);
+        }
+
+        quadrics[to] += quadrics[from];
+        is_removed[from] = true;
+        versions[to] += 1;
+
+        // Only the merged vertex's quadric changed, so only the edges
+        // touching it need costing again. Other collapses of its
+        // neighbours are still valid.
+        for (auto triangle : triangles_at[to]) {
+            if (is_triangle_removed[triangle]) {
+                continue;
+            }
+            for (int corner = 0; corner < 3; corner++) {
+                auto neighbour = corner_position(triangle, corner);
+                if (neighbour != to) {
+                    push(neighbour, to);
+                    push(to, neighbour);
+                }
+            }
+        }
+    }
+
+    // Keep every attribute, unused vertices are dropped by the optimiser
+    MeshBuilder simplified = builder;
+    simplified.m_indicies.clear();
+    for (size_t triangle = 0; triangle < triangle_count; triangle++) {
+        if (!is_triangle_removed[triangle]) {
+            simplified.m_indicies.insert(simplified.m_indicies.end(), &triangles[triangle * 3], &triangles[triangle * 3 + 3]);
+        }
+    }
+
+    MeshOptimizer::optimize(simplified);
+    return simplified;
+}
+
+std::vector<MeshBuilder> MeshSimplifier::build_lods(MeshBuilder const& builder, int level_count, float ratio)
+{
+    std::vector<MeshBuilder> levels = { builder };
+    while (static_cast<int>(levels.size()) < level_count) {
+        auto const& previous = levels.back();
+        auto previous_triangles = previous.m_indicies.size() / 3;
+        auto level = simplify(previous, static_cast<size_t>(previous_triangles * ratio));
+
+        // Not worth a level of its own if barely any simpler
+        if (level.m_indicies.size() / 3 > previous_triangles * 0.9f) {
+            break;
+        }
+        levels.push_back(std::move(level));
+    }
+
+    return levels;
+}
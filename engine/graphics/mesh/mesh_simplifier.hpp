@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/forward.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace Engine {
+
+// Reduces a mesh's triangle count by collapsing edges in order of least
+// quadric error (Garland and Heckbert). Vertices are collapsed by
+// position, so seams in normals or UVs move together and don't tear.
+// Open borders are kept in place to preserve silhouettes.
+class MeshSimplifier {
+public:
+    // Stops once the mesh has no more than the target number of
+    // triangles, or there's nothing left it can collapse
+    static MeshBuilder simplify(MeshBuilder const&, size_t target_triangles);
+
+    // Level 0 is the mesh as given, each level after has at most ratio
+    // times the triangles of the one before. Stops early if a level
+    // can't be reduced much further.
+    static std::vector<MeshBuilder> build_lods(MeshBuilder const&, int level_count, float ratio = 0.5f);
+};
+
+}
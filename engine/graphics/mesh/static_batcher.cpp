@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "static_batcher.hpp"
+using namespace Engine;
+
+void StaticBatcher::add(MeshBuilder const& builder, glm::mat4 const& transform, Material const& material)
+{
+    // Empty parts add nothing, so any cell will do
+    auto bounds = builder.bounds().transformed(transform);
+    auto center = bounds.is_empty() ? glm::vec3(0) : bounds.center();
+    auto cell = glm::ivec2(glm::floor(glm::vec2(center.x, center.z) / m_cell_size));
+
+    for (auto& batch : m_batches) {
+        if (batch.cell == cell && batch.material == material && batch.builder.has_same_layout(builder)) {
+            batch.builder.add_transformed(builder, transform);
+            batch.part_count += 1;
+            return;
+        }
+    }
+
+    m_batches.push_back(Batch { material, cell, MeshBuilder(), 1 });
+    m_batches.back().builder.add_transformed(builder, transform);
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/graphics/mesh/material.hpp"
+#include "engine/graphics/mesh/mesh_builder.hpp"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace Engine {
+
+// Merges meshes which never move into one mesh per material, with each
+// part's transform baked into its vertices, so they draw in one call.
+// Parts are grouped into a grid of cells on the ground by where their
+// centre lands, so each batch stays small enough to be frustum culled.
+class StaticBatcher {
+public:
+    static constexpr float default_cell_size = 16.0f;
+
+    struct Batch {
+        Material material;
+        glm::ivec2 cell;
+        MeshBuilder builder;
+        int part_count;
+    };
+
+    explicit StaticBatcher(float cell_size = default_cell_size)
+        : m_cell_size(cell_size)
+    {
+    }
+
+    void add(MeshBuilder const&, glm::mat4 const& transform, Material const&);
+
+    [[nodiscard]] inline std::vector<Batch> const& batches() const { return m_batches; }
+
+private:
+    float m_cell_size;
+    std::vector<Batch> m_batches;
+};
+
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "vertex_layout.hpp"
+using namespace Engine;
+
+size_t VertexLayout::size_of(Format format)
+{
+    switch (format) {
+    case Format::Float3:
+        return 3 * sizeof(float);
+    case Format::OctahedralNormal:
+        return 2 * sizeof(int16_t);
+    case Format::PackedTangent:
+        return sizeof(uint32_t);
+    case Format::Half4:
+        return 4 * sizeof(uint16_t);
+    }
+
+    return 0;
+}
+
+void VertexLayout::add(Format format)
+{
+    m_attributes.push_back(Attribute { format, m_stride });
+    m_stride += size_of(format);
+}
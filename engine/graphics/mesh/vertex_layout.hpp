@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Engine {
+
+// How a mesh's attributes are packed into its single interleaved vertex
+// buffer. Attributes take locations in the order they're added.
+class VertexLayout {
+public:
+    enum class Format {
+        // Three 32-bit floats
+        Float3,
+
+        // Unit vector folded onto an octahedron, as two 16-bit snorms.
+        // Read as a vec2, see decode_octahedral in the shaders.
+        OctahedralNormal,
+
+        // Tangent as 10-bit snorms, with the bitangent's handedness in w.
+        // Read as a vec4.
+        PackedTangent,
+
+        // Four 16-bit floats
+        Half4,
+    };
+
+    struct Attribute {
+        Format format;
+        size_t offset;
+    };
+
+    void add(Format);
+
+    [[nodiscard]] inline std::vector<Attribute> const& attributes() const { return m_attributes; }
+    [[nodiscard]] inline size_t stride() const { return m_stride; }
+
+    static size_t size_of(Format);
+
+private:
+    std::vector<Attribute> m_attributes;
+    size_t m_stride { 0 };
+};
+
+}
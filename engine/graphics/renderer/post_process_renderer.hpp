@@ -17,8 +17,6 @@ public:
     explicit PostProcessRenderer(std::shared_ptr<Shader> shader);
     virtual ~PostProcessRenderer();
 
-    void on_world_updated(Object::GameObject&) final { }
-
 protected:
     glm::mat4 projection_matrix(int width, int height) final;
     void on_start_frame() final { }
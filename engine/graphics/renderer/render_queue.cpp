@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "render_queue.hpp"
+#include "engine/graphics/mesh/mesh.hpp"
+#include "engine/graphics/texture/texture.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+using namespace Engine;
+
+#define INSTANCE_MODEL_MATRIX_LOCATION 8
+#define INSTANCE_MATERIAL_INDEX_LOCATION 12
+
+static std::vector<RenderQueue*>& all_queues()
+{
+    static std::vector<RenderQueue*> queues;
+    return queues;
+}
+
+RenderQueue::RenderQueue(char const* name)
+    : m_name(name)
+{
+    glGenBuffers(1, &m_instance_buffer);
+    all_queues().push_back(this);
+}
+
+RenderQueue::~RenderQueue()
+{
+    glDeleteBuffers(1, &m_instance_buffer);
+    std::erase(all_queues(), this);
+}
+
+void RenderQueue::for_each(std::function<void(RenderQueue const&)> const& callback)
+{
+    for (auto const* queue : all_queues()) {
+        callback(*queue);
+    }
+}
+
+static uint64_t bits(uint64_t value, int count, int shift)
+{
+    return (value & ((uint64_t(1) << count) - 1)) << shift;
+}
+
+uint64_t RenderQueue::sort_key(GLuint program, Draw const& draw)
+{
+    auto texture_id = [&](int slot) -> uint64_t {
+        auto const* texture = draw.textures[slot];
+        return texture ? texture->id() : 0;
+    };
+
+    // Most expensive to change first. The material is per instance, so
+    // comes after the mesh to keep instances of a mesh together. Ids are
+    // truncated, which only costs some ordering if two collide, never
+    // correctness.
+    //   program:8 | diffuse:12 | normal:12 | light:12 | mesh:12 | material:8
+    return bits(program, 8, 56)
+        | bits(texture_id(0), 12, 44)
+        | bits(texture_id(1), 12, 32)
+        | bits(texture_id(2), 12, 20)
+        | bits(draw.mesh->id(), 12, 8)
+        | bits(draw.material_index, 8, 0);
+}
+
+void RenderQueue::submit(GLuint program, Draw const& draw)
+{
+    m_entries.push_back(Entry { sort_key(program, draw), m_draws.size() });
+    m_draws.push_back(draw);
+}
+
+void RenderQueue::bind_instances(size_t first_instance)
+{
+    // Attribute pointers are part of the mesh's vertex array, so this is
+    // done after binding it
+    auto offset = first_instance * sizeof(Instance);
+    for (int column = 0; column < 4; column++) {
+        auto location = INSTANCE_MODEL_MATRIX_LOCATION + column;
+        auto column_offset = offset + offsetof(Instance, model_matrix) + column * sizeof(glm::vec4);
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void const*>(column_offset));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    auto material_offset = offset + offsetof(Instance, material_index);
+    glEnableVertexAttribArray(INSTANCE_MATERIAL_INDEX_LOCATION);
+    glVertexAttribPointer(INSTANCE_MATERIAL_INDEX_LOCATION, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), reinterpret_cast<void const*>(material_offset));
+    glVertexAttribDivisor(INSTANCE_MATERIAL_INDEX_LOCATION, 1);
+}
+
+void RenderQueue::flush()
+{
+    std::sort(m_entries.begin(), m_entries.end(), [](auto const& a, auto const& b) {
+        return a.key < b.key;
+    });
+
+    m_requested = Stats {};
+    m_issued = Stats {};
+    m_requested.draws = m_entries.size();
+    m_requested.draw_calls = m_entries.size();
+    m_requested.texture_binds = m_entries.size() * texture_slots;
+    m_requested.mesh_binds = m_entries.size();
+    m_issued.draws = m_entries.size();
+    if (m_entries.empty()) {
+        return;
+    }
+
+    auto effective_textures = [](Draw const& draw) {
+        auto textures = draw.textures;
+        for (auto& texture : textures) {
+            if (texture && !texture->has_loaded()) {
+                texture = nullptr;
+            }
+        }
+        return textures;
+    };
+
+    // Every instance goes in one upload, in draw order
+    m_instances.clear();
+    for (auto const& entry : m_entries) {
+        auto const& draw = m_draws[entry.index];
+        m_instances.push_back(Instance { draw.model_matrix, static_cast<float>(draw.material_index) });
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_instance_buffer);
+    glBufferData(GL_ARRAY_BUFFER, m_instances.size() * sizeof(Instance), m_instances.data(), GL_STREAM_DRAW);
+
+    // Nothing is known about the state other renderers left behind
+    std::array<Texture const*, texture_slots> bound_textures {};
+    std::array<bool, texture_slots> is_slot_known {};
+    Mesh const* bound_mesh = nullptr;
+
+    size_t first = 0;
+    while (first < m_entries.size()) {
+        auto const& draw = m_draws[m_entries[first].index];
+        auto textures = effective_textures(draw);
+
+        // Extend the run while the mesh and textures match
+        size_t last = first + 1;
+        while (last < m_entries.size()) {
+            auto const& next = m_draws[m_entries[last].index];
+            if (next.mesh != draw.mesh || effective_textures(next) != textures) {
+                break;
+            }
+            last += 1;
+        }
+
+        for (int slot = 0; slot < texture_slots; slot++) {
+            auto const* texture = textures[slot];
+            if (is_slot_known[slot] && bound_textures[slot] == texture) {
+                continue;
+            }
+
+            if (texture) {
+                texture->bind(slot);
+            } else {
+                Texture::unbind(slot);
+            }
+            bound_textures[slot] = texture;
+            is_slot_known[slot] = true;
+            m_issued.texture_binds += 1;
+        }
+
+        if (bound_mesh != draw.mesh) {
+            draw.mesh->bind();
+            bound_mesh = draw.mesh;
+            m_issued.mesh_binds += 1;
+        }
+
+        // Rebound for each run, as it starts at a different instance
+        bind_instances(first);
+        draw.mesh->draw_instanced(static_cast<int>(last - first));
+        m_issued.draw_calls += 1;
+        first = last;
+    }
+
+    Mesh::unbind();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    for (int slot = 0; slot < texture_slots; slot++) {
+        if (bound_textures[slot]) {
+            Texture::unbind(slot);
+        }
+    }
+
+    m_entries.clear();
+    m_draws.clear();
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/forward.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <vector>
+
+typedef unsigned int GLuint;
+
+namespace Engine {
+
+// Collects a frame's draws, then issues them sorted by the state they
+// need, so draws sharing textures and meshes run back to back. Only the
+// state that differs from the previous draw is bound.
+//
+// Draws of the same mesh with the same textures are issued as a single
+// instanced draw. Each instance's model matrix and material index are
+// passed as vertex attributes, from location 8 on.
+class RenderQueue {
+public:
+    static constexpr int texture_slots = 3;
+
+    struct Draw {
+        Mesh const* mesh;
+
+        // Null, or a texture that's yet to load, leaves the slot empty
+        std::array<Texture const*, texture_slots> textures;
+
+        int material_index;
+        glm::mat4 model_matrix;
+    };
+
+    struct Stats {
+        size_t draws { 0 };
+        size_t draw_calls { 0 };
+        size_t texture_binds { 0 };
+        size_t mesh_binds { 0 };
+
+        [[nodiscard]] inline size_t state_changes() const { return texture_binds + mesh_binds; }
+    };
+
+    explicit RenderQueue(char const* name);
+    ~RenderQueue();
+    RenderQueue(RenderQueue const&) = delete;
+    RenderQueue& operator=(RenderQueue const&) = delete;
+
+    // The program is part of the sort key, so queues may be shared by
+    // renderers with different shaders
+    void submit(GLuint program, Draw const&);
+
+    // Issues every submitted draw, then empties the queue. Texture slots
+    // are left unbound.
+    void flush();
+
+    [[nodiscard]] inline char const* name() const { return m_name; }
+
+    // For the last flushed frame, what drawing and binding everything for
+    // every draw would have cost, against what was actually issued
+    [[nodiscard]] inline Stats const& requested() const { return m_requested; }
+    [[nodiscard]] inline Stats const& issued() const { return m_issued; }
+
+    static void for_each(std::function<void(RenderQueue const&)> const&);
+
+private:
+    static uint64_t sort_key(GLuint program, Draw const&);
+    void bind_instances(size_t first_instance);
+
+    struct Entry {
+        uint64_t key;
+        size_t index;
+    };
+
+    struct Instance {
+        glm::mat4 model_matrix;
+        float material_index;
+    };
+
+    char const* m_name;
+    std::vector<Draw> m_draws;
+    std::vector<Entry> m_entries;
+    std::vector<Instance> m_instances;
+    GLuint m_instance_buffer { 0 };
+
+    Stats m_requested;
+    Stats m_issued;
+};
+
+}
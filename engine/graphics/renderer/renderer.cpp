@@ -5,10 +5,13 @@
  */
 
 #include "renderer.hpp"
+#include "engine/graphics/mesh/mesh.hpp"
 #include "engine/graphics/shader.hpp"
 #include "gameobject/gameobject.hpp"
+#include "gameobject/mesh_render.hpp"
 #include "gameobject/transform.hpp"
 #include <GL/glew.h>
+#include <algorithm>
 using namespace Engine;
 using namespace Object;
 
@@ -30,10 +33,156 @@ void Renderer::view_matrix(GameObject const& camera)
     m_camera_position = transform->position();
 }
 
+void Renderer::on_component_added(GameObject& game_object, Component& component)
+{
+    // Needs both, which may be added in either order
+    auto type_index = component.type_index();
+    if (type_index == MeshRender::static_type_index() || type_index == Transform::static_type_index()) {
+        add_mesh_render(game_object);
+    }
+}
+
+void Renderer::on_component_removed(GameObject& game_object, Component& component)
+{
+    auto type_index = component.type_index();
+    if (type_index == MeshRender::static_type_index()) {
+        remove_mesh_render(static_cast<MeshRender const&>(component));
+        return;
+    }
+
+    if (type_index == Transform::static_type_index() && game_object.first<Transform>() == &component) {
+        auto const* mesh_render = game_object.first<MeshRender>();
+        if (mesh_render) {
+            remove_mesh_render(*mesh_render);
+        }
+    }
+}
+
+void Renderer::on_enabled_changed(GameObject&)
+{
+    m_is_activity_dirty = true;
+}
+
+void Renderer::on_object_destroyed(GameObject& game_object)
+{
+    if (m_camera == &game_object) {
+        m_camera = nullptr;
+    }
+}
+
+void Renderer::update_activity()
+{
+    for (auto& data : m_mesh_renders) {
+        data.is_active = data.game_object->is_active();
+    }
+}
+
+void Renderer::add_mesh_render(GameObject const& game_object)
+{
+    auto const* mesh_render = game_object.first<MeshRender>();
+    auto const* transform = game_object.first<Transform>();
+    if (!mesh_render || !transform || &mesh_render->renderer() != this) {
+        return;
+    }
+
+    if (m_mesh_render_indices.contains(mesh_render)) {
+        return;
+    }
+
+    auto const* root = &game_object;
+    while (root->parent() && root->parent()->parent()) {
+        root = root->parent();
+    }
+
+    m_mesh_render_indices.emplace(mesh_render, m_mesh_renders.size());
+    m_mesh_renders.push_back(MeshRenderData {
+        .game_object = &game_object,
+        .transform = transform,
+        .mesh_render = mesh_render,
+        .is_active = game_object.is_active(),
+        .material_index = 0,
+        .lod = 0,
+        .root = root,
+        .model_matrix = glm::mat4(0),
+        .world_bounds = {},
+    });
+    m_are_materials_dirty = true;
+    m_are_culling_groups_dirty = true;
+}
+
+void Renderer::remove_mesh_render(MeshRender const& mesh_render)
+{
+    auto it = m_mesh_render_indices.find(&mesh_render);
+    if (it == m_mesh_render_indices.end()) {
+        return;
+    }
+
+    auto index = it->second;
+    m_mesh_render_indices.erase(it);
+
+    m_mesh_renders[index] = m_mesh_renders.back();
+    m_mesh_renders.pop_back();
+    if (index < m_mesh_renders.size()) {
+        m_mesh_render_indices[m_mesh_renders[index].mesh_render] = index;
+    }
+    m_are_materials_dirty = true;
+    m_are_culling_groups_dirty = true;
+}
+
+void Renderer::rebuild_culling_groups()
+{
+    std::stable_sort(m_mesh_renders.begin(), m_mesh_renders.end(), [](auto const& a, auto const& b) {
+        return a.root < b.root;
+    });
+
+    m_culling_groups.clear();
+    for (size_t i = 0; i < m_mesh_renders.size(); i++) {
+        m_mesh_render_indices[m_mesh_renders[i].mesh_render] = i;
+        if (m_culling_groups.empty() || m_mesh_renders[m_culling_groups.back().begin].root != m_mesh_renders[i].root) {
+            m_culling_groups.push_back(CullingGroup { i, i, {} });
+        }
+        m_culling_groups.back().end = i + 1;
+    }
+
+    // Entries have moved, so their bounds no longer match
+    for (auto& data : m_mesh_renders) {
+        data.model_matrix = glm::mat4(0);
+    }
+}
+
+void Renderer::update_bounds()
+{
+    for (auto& group : m_culling_groups) {
+        group.bounds = {};
+        for (size_t i = group.begin; i < group.end; i++) {
+            auto& data = m_mesh_renders[i];
+            auto model_matrix = data.transform->global_transform(*data.game_object);
+            if (model_matrix != data.model_matrix) {
+                data.model_matrix = model_matrix;
+                data.world_bounds = data.mesh_render->mesh().bounds().transformed(model_matrix);
+            }
+
+            if (data.is_active) {
+                group.bounds.extend(data.world_bounds);
+            }
+        }
+    }
+}
+
 void Renderer::render()
 {
     glViewport(0, 0, m_width, m_height);
 
+    if (m_is_activity_dirty) {
+        update_activity();
+        m_is_activity_dirty = false;
+    }
+
+    if (m_are_culling_groups_dirty) {
+        rebuild_culling_groups();
+        m_are_culling_groups_dirty = false;
+    }
+
     if (m_camera) {
         view_matrix(*m_camera);
     } else {
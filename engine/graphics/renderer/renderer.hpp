@@ -7,14 +7,18 @@
 #pragma once
 
 #include "engine/forward.hpp"
+#include "engine/math/aabb.hpp"
 #include "gameobject/forward.hpp"
+#include "gameobject/world_listener.hpp"
 #include <glm/glm.hpp>
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace Engine {
 
-class Renderer {
+class Renderer : public Object::WorldListener {
 public:
     explicit Renderer(std::shared_ptr<Shader> shader)
         : m_shader(std::move(shader))
@@ -23,21 +27,69 @@ public:
 
     inline void set_camera(Object::GameObject& camera) { m_camera = &camera; }
 
+    // A material drawn by this renderer has been changed
+    inline void mark_materials_dirty() { m_are_materials_dirty = true; }
+
     void resize_viewport(int width, int height);
     void render();
 
     virtual void pre_render() { }
-    virtual void on_world_updated(Object::GameObject&) = 0;
+
+    void on_component_added(Object::GameObject&, Object::Component&) override;
+    void on_component_removed(Object::GameObject&, Object::Component&) override;
+    void on_enabled_changed(Object::GameObject&) override;
+    void on_object_destroyed(Object::GameObject&) override;
 
 protected:
     virtual glm::mat4 projection_matrix(int width, int height) = 0;
     virtual void on_start_frame() = 0;
     virtual void on_render() = 0;
 
+    // Refreshes each entry's is_active after an object has been enabled
+    // or disabled
+    virtual void update_activity();
+
+    struct MeshRenderData {
+        Object::GameObject const* game_object;
+        Object::Transform const* transform;
+        Object::MeshRender const* mesh_render;
+        bool is_active;
+
+        // Slot in the renderer's material table, for those that keep one
+        int material_index;
+
+        // Level of detail last drawn, for those that pick one
+        int lod;
+
+        // The object below the world this one is part of, see CullingGroup
+        Object::GameObject const* root;
+
+        // Kept by update_bounds, for those that cull
+        glm::mat4 model_matrix;
+        AABB world_bounds;
+    };
+
+    // A run of mesh renders under the same root object, bounded as a whole
+    // so they can be rejected together
+    struct CullingGroup {
+        size_t begin;
+        size_t end;
+        AABB bounds;
+    };
+
+    // Brings each entry's model matrix and world bounds, and each group's
+    // bounds, up to date with its transform
+    void update_bounds();
+
+    // Every mesh render drawn by this renderer, grouped by root object
+    std::vector<MeshRenderData> m_mesh_renders;
+    std::vector<CullingGroup> m_culling_groups;
+
     std::shared_ptr<Shader> m_shader;
     glm::mat4 m_projection_matrix {};
     glm::mat4 m_view {};
     glm::vec3 m_camera_position {};
+    bool m_are_materials_dirty { true };
 
     inline int width() const { return m_width; }
     inline int height() const { return m_height; }
@@ -45,6 +97,14 @@ protected:
 private:
     void view_matrix(Object::GameObject const& camera);
 
+    void add_mesh_render(Object::GameObject const&);
+    void remove_mesh_render(Object::MeshRender const&);
+    void rebuild_culling_groups();
+
+    std::unordered_map<Object::MeshRender const*, size_t> m_mesh_render_indices;
+    bool m_is_activity_dirty { false };
+    bool m_are_culling_groups_dirty { true };
+
     Object::GameObject* m_camera { nullptr };
     int m_width { 0 };
     int m_height { 0 };
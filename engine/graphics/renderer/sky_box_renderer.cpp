@@ -21,6 +21,8 @@ using namespace glm;
 
 SkyBoxRenderer::SkyBoxRenderer(std::shared_ptr<Shader> shader)
     : Renderer(std::move(shader))
+    , m_diffuse_map_uniform(m_shader->uniform<int>("diffuse_map"))
+    , m_mvp_uniform(m_shader->uniform<glm::mat4>("mvp"))
 {
 }
 
@@ -28,30 +30,6 @@ SkyBoxRenderer::~SkyBoxRenderer()
 {
 }
 
-void SkyBoxRenderer::on_world_updated(Object::GameObject& world)
-{
-    m_mesh_renders.clear();
-    world.for_each([&](GameObject const& game_object) {
-        const auto* transform = game_object.first<Transform>();
-        if (!transform) {
-            return IteratorDecision::Continue;
-        }
-
-        const auto* mesh_render = game_object.first<MeshRender>();
-        if (!mesh_render || &mesh_render->renderer() != this) {
-            return IteratorDecision::Continue;
-        }
-
-        m_mesh_renders.push_back(MeshRenderData {
-            .game_object = game_object,
-            .transform = *transform,
-            .mesh_render = *mesh_render,
-        });
-
-        return IteratorDecision::Continue;
-    });
-}
-
 glm::mat4 SkyBoxRenderer::projection_matrix(int width, int height)
 {
     float aspect_ratio = (float)width / (float)height;
@@ -70,16 +48,20 @@ void SkyBoxRenderer::on_render()
     glDisable(GL_DEPTH_TEST);
 
     for (auto const& data : m_mesh_renders) {
-        auto global_transform = data.transform.global_transform(data.game_object);
-        auto const& material = data.mesh_render.material();
-        m_shader->load_int("diffuse_map", 0);
-        m_shader->load_matrix("mvp", m_projection_matrix * m_view * global_transform);
+        if (!data.is_active) {
+            continue;
+        }
+
+        auto global_transform = data.transform->global_transform(*data.game_object);
+        auto const& material = data.mesh_render->material();
+        m_shader->load(m_diffuse_map_uniform, 0);
+        m_shader->load(m_mvp_uniform, m_projection_matrix * m_view * global_transform);
 
         if (material.diffuse_map && material.diffuse_map->has_loaded()) {
             material.diffuse_map->bind(0);
         }
 
-        data.mesh_render.mesh().draw();
+        data.mesh_render->mesh().draw();
         Texture::unbind(0);
     }
 
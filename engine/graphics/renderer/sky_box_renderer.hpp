@@ -8,6 +8,7 @@
 
 #include "engine/forward.hpp"
 #include "engine/graphics/renderer/renderer.hpp"
+#include "engine/graphics/shader.hpp"
 #include "gameobject/forward.hpp"
 #include <vector>
 
@@ -18,20 +19,14 @@ public:
     SkyBoxRenderer(std::shared_ptr<Shader> shader);
     virtual ~SkyBoxRenderer();
 
-    virtual void on_world_updated(Object::GameObject&) final;
-
 protected:
     virtual glm::mat4 projection_matrix(int width, int height) final;
     virtual void on_start_frame() final;
     virtual void on_render() final;
 
-    struct MeshRenderData {
-        Object::GameObject const& game_object;
-        Object::Transform const& transform;
-        Object::MeshRender const& mesh_render;
-    };
-
-    std::vector<MeshRenderData> m_mesh_renders;
+private:
+    Shader::Uniform<int> m_diffuse_map_uniform;
+    Shader::Uniform<glm::mat4> m_mvp_uniform;
 };
 
 }
@@ -5,62 +5,216 @@
  */
 
 #include "standard_renderer.hpp"
+#include "engine/graphics/mesh/material.hpp"
 #include "engine/graphics/mesh/mesh.hpp"
 #include "engine/graphics/shader.hpp"
 #include "engine/graphics/texture/texture.hpp"
+#include "engine/graphics/uniform_buffer.hpp"
+#include "engine/math/frustum.hpp"
 #include "gameobject/gameobject.hpp"
 #include "gameobject/light.hpp"
 #include "gameobject/mesh_render.hpp"
 #include "gameobject/transform.hpp"
 #include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <glm/gtx/transform.hpp>
+#include <iostream>
+#include <string_view>
 using namespace Engine;
 using namespace Object;
 
 #define MAX_LIGHT_COUNT 10
+// GL guarantees uniform blocks of at least 16KB, so this is as many as
+// fit everywhere. Must match the Materials block in the shaders.
+#define MAX_MATERIAL_COUNT 256
+
+#define FRAME_DATA_BINDING 0
+#define MATERIALS_BINDING 1
+
+// Mirror the std140 blocks in the shader, vec3s are padded out to a vec4
+struct FrameData {
+    glm::mat4 view_projection;
+    glm::vec3 camera_position;
+    int point_light_count;
+
+    struct {
+        glm::vec3 position;
+        float padding0;
+        glm::vec3 color;
+        float padding1;
+    } point_lights[MAX_LIGHT_COUNT];
+};
+
+struct MaterialData {
+    glm::vec3 color;
+    float normal_map_strength;
+    glm::vec3 specular_color;
+    float specular_focus;
+    glm::vec3 emission_color;
+    float metallic;
+    int has_light_map;
+    int padding[3];
+};
+
+static_assert(sizeof(FrameData) == 80 + MAX_LIGHT_COUNT * 32);
+static_assert(sizeof(MaterialData) == 64);
+static_assert(sizeof(MaterialData) * MAX_MATERIAL_COUNT <= 16384);
+
+// There's no implicit padding, so materials can be compared and hashed by
+// their bytes
+struct MaterialDataHash {
+    size_t operator()(MaterialData const& data) const
+    {
+        return std::hash<std::string_view> {}(std::string_view(reinterpret_cast<char const*>(&data), sizeof(MaterialData)));
+    }
+};
+
+struct MaterialDataEqual {
+    bool operator()(MaterialData const& a, MaterialData const& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(MaterialData)) == 0;
+    }
+};
 
 StandardRenderer::StandardRenderer(std::shared_ptr<Shader> shader, std::shared_ptr<Texture> sky_box)
     : Renderer(std::move(shader))
     , m_sky_box(std::move(sky_box))
 {
+    m_uniforms.diffuse_map = m_shader->uniform<int>("diffuse_map");
+    m_uniforms.normal_map = m_shader->uniform<int>("normal_map");
+    m_uniforms.light_map = m_shader->uniform<int>("light_map");
+    m_uniforms.sky_box = m_shader->uniform<int>("sky_box");
+
+    m_frame_buffer = UniformBuffer::construct(FRAME_DATA_BINDING, sizeof(FrameData));
+    m_material_buffer = UniformBuffer::construct(MATERIALS_BINDING, sizeof(MaterialData) * MAX_MATERIAL_COUNT);
+    m_shader->bind_uniform_block("FrameData", FRAME_DATA_BINDING);
+    m_shader->bind_uniform_block("Materials", MATERIALS_BINDING);
 }
 
 StandardRenderer::~StandardRenderer()
 {
 }
 
-void StandardRenderer::on_world_updated(Object::GameObject& world)
+void StandardRenderer::on_component_added(GameObject& game_object, Component& component)
 {
-    m_mesh_renders.clear();
-    m_lights.clear();
+    Renderer::on_component_added(game_object, component);
 
-    world.for_each([&](GameObject const& game_object) {
-        const auto* transform = game_object.first<Transform>();
-        if (!transform) {
-            return IteratorDecision::Continue;
-        }
+    auto type_index = component.type_index();
+    if (type_index == Light::static_type_index() || type_index == Transform::static_type_index()) {
+        add_light(game_object);
+    }
+}
 
-        const auto* mesh_render = game_object.first<MeshRender>();
-        if (mesh_render && &mesh_render->renderer() == this) {
-            m_mesh_renders.push_back(MeshRenderData {
-                .game_object = game_object,
-                .transform = *transform,
-                .mesh_render = *mesh_render,
-            });
-        }
+void StandardRenderer::on_component_removed(GameObject& game_object, Component& component)
+{
+    Renderer::on_component_removed(game_object, component);
+
+    auto type_index = component.type_index();
+    if (type_index == Light::static_type_index()) {
+        remove_light(static_cast<Light const&>(component));
+        return;
+    }
 
-        const auto* light = game_object.first<Light>();
+    if (type_index == Transform::static_type_index() && game_object.first<Transform>() == &component) {
+        auto const* light = game_object.first<Light>();
         if (light) {
-            m_lights.push_back(LightData {
-                .transform = *transform,
-                .light = *light,
-            });
+            remove_light(*light);
         }
+    }
+}
+
+void StandardRenderer::update_activity()
+{
+    Renderer::update_activity();
+    for (auto& data : m_lights) {
+        data.is_active = data.game_object->is_active();
+    }
+}
+
+void StandardRenderer::add_light(GameObject const& game_object)
+{
+    auto const* light = game_object.first<Light>();
+    auto const* transform = game_object.first<Transform>();
+    if (!light || !transform || m_light_indices.contains(light)) {
+        return;
+    }
 
-        return IteratorDecision::Continue;
+    m_light_indices.emplace(light, m_lights.size());
+    m_lights.push_back(LightData {
+        .game_object = &game_object,
+        .transform = transform,
+        .light = light,
+        .is_active = game_object.is_active(),
     });
 }
 
+void StandardRenderer::remove_light(Light const& light)
+{
+    auto it = m_light_indices.find(&light);
+    if (it == m_light_indices.end()) {
+        return;
+    }
+
+    auto index = it->second;
+    m_light_indices.erase(it);
+
+    m_lights[index] = m_lights.back();
+    m_lights.pop_back();
+    if (index < m_lights.size()) {
+        m_light_indices[m_lights[index].light] = index;
+    }
+}
+
+void StandardRenderer::rebuild_material_table()
+{
+    // Renders share a slot with any material of the same values, not just
+    // the same material, so copies made to change a material only take a
+    // new slot when their values differ. Textures are bound per draw, so
+    // aren't part of it.
+    std::vector<MaterialData> table;
+    std::unordered_map<MaterialData, int, MaterialDataHash, MaterialDataEqual> indices;
+    bool has_overflowed = false;
+    for (auto& data : m_mesh_renders) {
+        auto const& material = data.mesh_render->material();
+        auto material_data = MaterialData {
+            .color = material.color,
+            .normal_map_strength = material.normal_map_strength,
+            .specular_color = material.specular_color,
+            .specular_focus = material.specular_focus,
+            .emission_color = material.emission_color,
+            .metallic = material.metallic,
+            .has_light_map = material.light_map != nullptr,
+            .padding = {},
+        };
+
+        auto it = indices.find(material_data);
+        if (it != indices.end()) {
+            data.material_index = it->second;
+            continue;
+        }
+
+        if (table.size() >= MAX_MATERIAL_COUNT) {
+            has_overflowed = true;
+            data.material_index = 0;
+            continue;
+        }
+
+        data.material_index = static_cast<int>(table.size());
+        indices.emplace(material_data, data.material_index);
+        table.push_back(material_data);
+    }
+
+    if (has_overflowed) {
+        std::cerr << "Error: More than " << MAX_MATERIAL_COUNT << " distinct materials in use, the rest are drawn with the first\n";
+    }
+
+    if (!table.empty()) {
+        m_material_buffer->upload(table.data(), table.size() * sizeof(MaterialData));
+    }
+}
+
 glm::mat4 StandardRenderer::projection_matrix(int width, int height)
 {
     float const aspect_ratio = (float)width / (float)height;
@@ -69,58 +223,110 @@ glm::mat4 StandardRenderer::projection_matrix(int width, int height)
 
 void StandardRenderer::on_start_frame()
 {
-    auto light_count = std::min((int)m_lights.size(), MAX_LIGHT_COUNT);
-    for (int i = 0; i < light_count; i++) {
-        LightData const& light = m_lights[i];
-        auto const& position = light.transform.position();
-        auto const& color = light.light.color();
+    if (m_are_materials_dirty) {
+        rebuild_material_table();
+        m_are_materials_dirty = false;
+    }
 
-        // TODO: This is extremely slow
-        m_shader->load_vec3("point_lights[" + std::to_string(i) + "].position", position);
-        m_shader->load_vec3("point_lights[" + std::to_string(i) + "].color", color);
+    FrameData frame_data {};
+    frame_data.view_projection = m_projection_matrix * m_view;
+    frame_data.camera_position = m_camera_position;
+    for (auto const& light : m_lights) {
+        if (frame_data.point_light_count >= MAX_LIGHT_COUNT) {
+            break;
+        }
+        if (!light.is_active) {
+            continue;
+        }
+
+        auto& point_light = frame_data.point_lights[frame_data.point_light_count];
+        point_light.position = light.transform->position();
+        point_light.color = light.light->color();
+        frame_data.point_light_count += 1;
     }
 
-    m_shader->load_int("point_light_count", light_count);
-    m_shader->load_vec3("camera_position", m_camera_position);
+    m_frame_buffer->upload(&frame_data, sizeof(FrameData));
+    m_frame_buffer->bind();
+    m_material_buffer->bind();
 
-    m_shader->load_int("diffuse_map", 0);
-    m_shader->load_int("normal_map", 1);
-    m_shader->load_int("light_map", 2);
-    m_shader->load_int("sky_box", 3);
+    m_shader->load(m_uniforms.diffuse_map, 0);
+    m_shader->load(m_uniforms.normal_map, 1);
+    m_shader->load(m_uniforms.light_map, 2);
+    m_shader->load(m_uniforms.sky_box, 3);
 }
 
-void StandardRenderer::on_render()
+void StandardRenderer::request_texture_detail(MeshRenderData const& data, Material const& material) const
 {
-    for (auto const& data : m_mesh_renders) {
-        auto global_transform = data.transform.global_transform(data.game_object);
-        auto const& material = data.mesh_render.material();
-        m_shader->load_matrix("model_matrix", global_transform);
-        m_shader->load_matrix("mvp", m_projection_matrix * m_view * global_transform);
-        m_shader->load_vec3("color", material.color);
-        m_shader->load_vec3("specular_color", material.specular_color);
-        m_shader->load_vec3("emission_color", material.emission_color);
-        m_shader->load_float("normal_map_strength", material.normal_map_strength);
-        m_shader->load_float("specular_focus", material.specular_focus);
-        m_shader->load_float("metallic", material.metallic);
-        m_shader->load_bool("has_light_map", material.light_map != nullptr);
-
-        if (material.diffuse_map && material.diffuse_map->has_loaded()) {
-            material.diffuse_map->bind(0);
-        }
-        if (material.normal_map && material.normal_map->has_loaded()) {
-            material.normal_map->bind(1);
+    auto uv_density = data.mesh_render->mesh().uv_density();
+    if (uv_density <= 0) {
+        return;
+    }
+
+    // The nearest point of the bounds is the most detail any of it needs
+    auto radius = glm::length(data.world_bounds.extent());
+    auto distance = std::max(glm::distance(data.world_bounds.center(), m_camera_position) - radius, 0.1f);
+    auto world_per_pixel = 2.0f * distance / (m_projection_matrix[1][1] * static_cast<float>(height()));
+
+    // Assumes near uniform scale. Light maps use the second UV set, but
+    // are close enough to the first.
+    auto scale = glm::length(glm::vec3(data.model_matrix[0]));
+    auto uv_per_pixel = world_per_pixel * std::sqrt(uv_density) / std::max(scale, 0.0001f);
+    for (auto const* texture : { material.diffuse_map.get(), material.normal_map.get(), material.light_map.get() }) {
+        if (texture) {
+            texture->request_detail(uv_per_pixel);
         }
-        if (material.light_map && material.light_map->has_loaded()) {
-            material.light_map->bind(2);
+    }
+}
+
+void StandardRenderer::on_render()
+{
+    update_bounds();
+
+    // Whole groups are rejected, or accepted, by their bounds. Only those
+    // crossing the edge of the view test their parts.
+    auto frustum = Frustum::from(m_projection_matrix * m_view);
+    for (auto const& group : m_culling_groups) {
+        auto containment = frustum.test(group.bounds);
+        if (containment == Frustum::Containment::Outside) {
+            continue;
         }
-        if (m_sky_box && m_sky_box->has_loaded()) {
-            m_sky_box->bind(3);
+
+        for (size_t i = group.begin; i < group.end; i++) {
+            auto& data = m_mesh_renders[i];
+            if (!data.is_active) {
+                continue;
+            }
+
+            if (containment == Frustum::Containment::Intersects && frustum.test(data.world_bounds) == Frustum::Containment::Outside) {
+                continue;
+            }
+
+            // Projected size of the bounds, as a fraction of the view's height
+            auto distance = std::max(glm::distance(data.world_bounds.center(), m_camera_position), 0.001f);
+            auto screen_size = glm::length(data.world_bounds.extent()) * m_projection_matrix[1][1] / distance;
+            data.lod = data.mesh_render->choose_lod(screen_size, data.lod);
+
+            auto const& material = data.mesh_render->material();
+            request_texture_detail(data, material);
+
+            m_queue.submit(m_shader->program(), RenderQueue::Draw {
+                .mesh = &data.mesh_render->mesh(data.lod),
+                .textures = { material.diffuse_map.get(), material.normal_map.get(), material.light_map.get() },
+                .material_index = data.material_index,
+                .model_matrix = data.model_matrix,
+            });
         }
+    }
+
+    // Shared by every draw, so only bound once
+    bool has_sky_box = m_sky_box && m_sky_box->has_loaded();
+    if (has_sky_box) {
+        m_sky_box->bind(3);
+    }
+
+    m_queue.flush();
 
-        data.mesh_render.mesh().draw();
-        Texture::unbind(0);
-        Texture::unbind(1);
-        Texture::unbind(2);
+    if (has_sky_box) {
         Texture::unbind(3);
     }
 }
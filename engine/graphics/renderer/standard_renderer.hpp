@@ -7,8 +7,11 @@
 #pragma once
 
 #include "engine/forward.hpp"
+#include "engine/graphics/renderer/render_queue.hpp"
 #include "engine/graphics/renderer/renderer.hpp"
+#include "engine/graphics/shader.hpp"
 #include "gameobject/forward.hpp"
+#include <unordered_map>
 #include <vector>
 
 namespace Engine {
@@ -18,27 +21,49 @@ public:
     StandardRenderer(std::shared_ptr<Shader> shader, std::shared_ptr<Texture> sky_box);
     virtual ~StandardRenderer();
 
-    virtual void on_world_updated(Object::GameObject&) final;
+    void on_component_added(Object::GameObject&, Object::Component&) final;
+    void on_component_removed(Object::GameObject&, Object::Component&) final;
 
 protected:
     virtual glm::mat4 projection_matrix(int width, int height) final;
     virtual void on_start_frame() final;
     virtual void on_render() final;
+    void update_activity() final;
 
     struct LightData {
-        Object::Transform const& transform;
-        Object::Light const& light;
-    };
-
-    struct MeshRenderData {
-        Object::GameObject const& game_object;
-        Object::Transform const& transform;
-        Object::MeshRender const& mesh_render;
+        Object::GameObject const* game_object;
+        Object::Transform const* transform;
+        Object::Light const* light;
+        bool is_active;
     };
 
     std::vector<LightData> m_lights;
-    std::vector<MeshRenderData> m_mesh_renders;
     std::shared_ptr<Texture> m_sky_box;
+
+private:
+    void add_light(Object::GameObject const&);
+    void remove_light(Object::Light const&);
+    void rebuild_material_table();
+
+    // Asks the material's textures for as much detail as the mesh's
+    // nearest point covers on screen
+    void request_texture_detail(MeshRenderData const&, Material const&) const;
+
+    std::unordered_map<Object::Light const*, size_t> m_light_indices;
+
+    struct Uniforms {
+        Shader::Uniform<int> diffuse_map;
+        Shader::Uniform<int> normal_map;
+        Shader::Uniform<int> light_map;
+        Shader::Uniform<int> sky_box;
+    };
+
+    Uniforms m_uniforms;
+    RenderQueue m_queue { "Standard" };
+
+    // The camera and lights, then every material in use
+    std::shared_ptr<UniformBuffer> m_frame_buffer;
+    std::shared_ptr<UniformBuffer> m_material_buffer;
 };
 
 }
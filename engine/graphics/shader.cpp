@@ -6,6 +6,7 @@
 
 #include "shader.hpp"
 #include <GL/glew.h>
+#include <cstring>
 #include <glm/gtx/string_cast.hpp>
 #include <iostream>
 #include <map>
@@ -132,6 +133,79 @@ bool Shader::link()
         return false;
     }
 
+    reflect_uniforms();
+    return true;
+}
+
+void Shader::reflect_uniforms()
+{
+    GLint uniform_count = 0;
+    GLint max_name_length = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+    std::string name_buffer(max_name_length, '\0');
+    for (GLint i = 0; i < uniform_count; i++) {
+        GLsizei name_length = 0;
+        GLint array_size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_program, i, max_name_length, &name_length, &array_size, &type, name_buffer.data());
+
+        // Arrays of basic types are reported once as "name[0]", but each
+        // element has its own location
+        auto name = name_buffer.substr(0, name_length);
+        auto is_array = name.ends_with("[0]");
+        auto base_name = is_array ? name.substr(0, name.size() - 3) : name;
+        for (GLint element = 0; element < array_size; element++) {
+            auto element_name = is_array ? base_name + "[" + std::to_string(element) + "]" : name;
+            auto location = glGetUniformLocation(m_program, element_name.c_str());
+            if (location < 0) {
+                continue;
+            }
+
+            auto index = static_cast<int>(m_uniforms.size());
+            m_uniforms.push_back(UniformData { location, {}, false });
+            m_uniform_indices.emplace(element_name, index);
+            if (element == 0) {
+                m_uniform_indices.emplace(base_name, index);
+            }
+        }
+    }
+}
+
+void Shader::bind_uniform_block(std::string_view name, GLuint binding)
+{
+    auto index = glGetUniformBlockIndex(m_program, std::string(name).c_str());
+    if (index == GL_INVALID_INDEX) {
+        return;
+    }
+
+    glUniformBlockBinding(m_program, index, binding);
+}
+
+int Shader::find_uniform(std::string_view name) const
+{
+    auto it = m_uniform_indices.find(std::string(name));
+    if (it == m_uniform_indices.end()) {
+        return -1;
+    }
+
+    return it->second;
+}
+
+bool Shader::update_cached(int index, void const* value, size_t size)
+{
+    if (index < 0) {
+        return false;
+    }
+
+    auto& uniform = m_uniforms[index];
+    if (uniform.has_value && std::memcmp(uniform.value.data(), value, size) == 0) {
+        return false;
+    }
+
+    std::memcpy(uniform.value.data(), value, size);
+    uniform.has_value = true;
     return true;
 }
 
@@ -151,51 +225,89 @@ void Shader::bind()
     glUseProgram(m_program);
 }
 
+void Shader::load(Uniform<glm::mat4> uniform, glm::mat4 const& matrix)
+{
+    if (update_cached(uniform.index, &matrix, sizeof(matrix))) {
+        glUniformMatrix4fv(m_uniforms[uniform.index].location, 1, GL_FALSE, (GLfloat const*)&matrix);
+    }
+}
+
+void Shader::load(Uniform<int> uniform, int i)
+{
+    if (update_cached(uniform.index, &i, sizeof(i))) {
+        glUniform1i(m_uniforms[uniform.index].location, i);
+    }
+}
+
+void Shader::load(Uniform<glm::vec2> uniform, glm::vec2 vec)
+{
+    if (update_cached(uniform.index, &vec, sizeof(vec))) {
+        glUniform2fv(m_uniforms[uniform.index].location, 1, (GLfloat*)&vec);
+    }
+}
+
+void Shader::load(Uniform<glm::vec3> uniform, glm::vec3 vec)
+{
+    if (update_cached(uniform.index, &vec, sizeof(vec))) {
+        glUniform3fv(m_uniforms[uniform.index].location, 1, (GLfloat*)&vec);
+    }
+}
+
+void Shader::load(Uniform<glm::vec4> uniform, glm::vec4 vec)
+{
+    if (update_cached(uniform.index, &vec, sizeof(vec))) {
+        glUniform4fv(m_uniforms[uniform.index].location, 1, (GLfloat*)&vec);
+    }
+}
+
+void Shader::load(Uniform<float> uniform, float f)
+{
+    if (update_cached(uniform.index, &f, sizeof(f))) {
+        glUniform1f(m_uniforms[uniform.index].location, f);
+    }
+}
+
+void Shader::load(Uniform<bool> uniform, bool b)
+{
+    int value = b;
+    if (update_cached(uniform.index, &value, sizeof(value))) {
+        glUniform1i(m_uniforms[uniform.index].location, value);
+    }
+}
+
 void Shader::load_matrix(std::string const& name, glm::mat4 matrix)
 {
-    auto location = get_uniform_location(name);
-    glUniformMatrix4fv(location, 1, GL_FALSE, (GLfloat const*)&matrix);
+    load(uniform<glm::mat4>(name), matrix);
 }
 
 void Shader::load_int(std::string const& name, int i)
 {
-    auto location = get_uniform_location(name);
-    glUniform1i(location, i);
+    load(uniform<int>(name), i);
 }
 
 void Shader::load_vec2(std::string const& name, glm::vec2 vec)
 {
-    auto location = get_uniform_location(name);
-    glUniform2fv(location, 1, (GLfloat*)&vec);
+    load(uniform<glm::vec2>(name), vec);
 }
 
 void Shader::load_vec3(std::string const& name, glm::vec3 vec)
 {
-    auto location = get_uniform_location(name);
-    glUniform3fv(location, 1, (GLfloat*)&vec);
+    load(uniform<glm::vec3>(name), vec);
 }
 
 void Shader::load_vec4(std::string const& name, glm::vec4 vec)
 {
-    auto location = get_uniform_location(name);
-    glUniform4fv(location, 1, (GLfloat*)&vec);
+    load(uniform<glm::vec4>(name), vec);
 }
 
 void Shader::load_float(std::string const& name, float f)
 {
-    auto location = get_uniform_location(name);
-    glUniform1f(location, f);
+    load(uniform<float>(name), f);
 }
 
 void Shader::load_bool(std::string const& name, bool b)
 {
-    auto location = get_uniform_location(name);
-    glUniform1i(location, b);
-}
-
-GLuint Shader::get_uniform_location(std::string const& name)
-{
-    return glGetUniformLocation(m_program, name.c_str());
+    load(uniform<bool>(name), b);
 }
 
 Shader::~Shader()
@@ -7,9 +7,13 @@
 #pragma once
 
 #include "engine/forward.hpp"
+#include <array>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
 typedef unsigned int GLuint;
 typedef unsigned int GLenum;
@@ -22,7 +26,32 @@ public:
     static std::shared_ptr<Shader> construct(std::istream& stream);
     ~Shader();
 
+    // A uniform looked up once, ahead of time. Loading through a handle
+    // to a uniform the program doesn't use does nothing.
+    template<typename T>
+    struct Uniform {
+        int index { -1 };
+    };
+
+    template<typename T>
+    [[nodiscard]] Uniform<T> uniform(std::string_view name) const { return Uniform<T> { find_uniform(name) }; }
+
+    // Points the named uniform block at a binding, see UniformBuffer. Does
+    // nothing if the program has no such block.
+    void bind_uniform_block(std::string_view name, GLuint binding);
+
+    // The shader must be bound. Values the program already has are skipped.
     void bind();
+    [[nodiscard]] inline GLuint program() const { return m_program; }
+
+    void load(Uniform<glm::mat4>, glm::mat4 const&);
+    void load(Uniform<int>, int);
+    void load(Uniform<glm::vec2>, glm::vec2);
+    void load(Uniform<glm::vec3>, glm::vec3);
+    void load(Uniform<glm::vec4>, glm::vec4);
+    void load(Uniform<float>, float);
+    void load(Uniform<bool>, bool);
+
     void load_matrix(std::string const& name, glm::mat4);
     void load_int(std::string const& name, int);
     void load_vec2(std::string const& name, glm::vec2);
@@ -36,7 +65,22 @@ private:
     GLuint m_fragment_shader;
     GLuint m_program;
 
-    GLuint get_uniform_location(std::string const& name);
+    struct UniformData {
+        int location;
+
+        // The last value loaded, big enough for a mat4
+        std::array<float, 16> value;
+        bool has_value;
+    };
+
+    [[nodiscard]] int find_uniform(std::string_view name) const;
+    void reflect_uniforms();
+
+    // Stores the value, returning false if the program already has it
+    bool update_cached(int index, void const* value, size_t size);
+
+    std::vector<UniformData> m_uniforms;
+    std::unordered_map<std::string, int> m_uniform_indices;
 
     bool link();
     std::string program_info_log() const;
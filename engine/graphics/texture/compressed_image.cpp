@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "compressed_image.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+using namespace Engine;
+
+static constexpr std::array<uint8_t, 12> s_identifier = {
+    0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+static constexpr uint32_t s_endianness = 0x04030201;
+
+struct Header {
+    uint32_t endianness;
+    uint32_t gl_type;
+    uint32_t gl_type_size;
+    uint32_t gl_format;
+    uint32_t gl_internal_format;
+    uint32_t gl_base_internal_format;
+    uint32_t pixel_width;
+    uint32_t pixel_height;
+    uint32_t pixel_depth;
+    uint32_t array_element_count;
+    uint32_t face_count;
+    uint32_t mip_level_count;
+    uint32_t key_value_data_size;
+};
+
+static bool is_bc_format(uint32_t format)
+{
+    return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+        || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        || format == GL_COMPRESSED_RG_RGTC2;
+}
+
+static bool is_etc_format(uint32_t format)
+{
+    return format == GL_COMPRESSED_RGB8_ETC2
+        || format == GL_COMPRESSED_RGBA8_ETC2_EAC
+        || format == GL_COMPRESSED_RG11_EAC;
+}
+
+std::string CompressedImage::name_for(std::string_view image_name)
+{
+    auto extension = image_name.rfind('.');
+    return std::string(image_name.substr(0, extension)) + ".ktx";
+}
+
+bool CompressedImage::read(std::istream& stream, std::string_view name, CompressedImage& image)
+{
+    return read_header(stream, name, image) && image.read_levels(stream, name, 0, image.m_level_count);
+}
+
+bool CompressedImage::read_header(std::istream& stream, std::string_view name, CompressedImage& image)
+{
+    std::array<uint8_t, 12> identifier {};
+    Header header {};
+    stream.read(reinterpret_cast<char*>(identifier.data()), identifier.size());
+    stream.read(reinterpret_cast<char*>(&header), sizeof(Header));
+    if (!stream || identifier != s_identifier || header.endianness != s_endianness) {
+        std::cerr << "Error: '" << name << "' is not a KTX file\n";
+        return false;
+    }
+
+    if (header.gl_type != 0 || !(is_bc_format(header.gl_internal_format) || is_etc_format(header.gl_internal_format))) {
+        std::cerr << "Error: '" << name << "' is not in a supported block compressed format\n";
+        return false;
+    }
+
+    if (header.pixel_depth > 1 || header.array_element_count > 0 || header.face_count != 1) {
+        std::cerr << "Error: '" << name << "' is not a plain 2D texture\n";
+        return false;
+    }
+
+    stream.ignore(header.key_value_data_size);
+    image.m_format = header.gl_internal_format;
+    image.m_width = static_cast<int>(header.pixel_width);
+    image.m_height = static_cast<int>(header.pixel_height);
+    image.m_level_count = static_cast<int>(std::max(header.mip_level_count, 1u));
+    image.m_levels.clear();
+    return true;
+}
+
+bool CompressedImage::read_levels(std::istream& stream, std::string_view name, int first, int end)
+{
+    m_levels.clear();
+    for (int level = 0; level < std::min(end, m_level_count); level++) {
+        uint32_t size = 0;
+        stream.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+        // Blocks are 8 or 16 bytes, so levels never need padding
+        if (level < first) {
+            stream.seekg(size, std::ios::cur);
+            continue;
+        }
+
+        auto& data = m_levels.emplace_back(Level { level, level_width(level), level_height(level), {} }).data;
+        data.resize(size);
+        stream.read(reinterpret_cast<char*>(data.data()), size);
+    }
+
+    if (!stream) {
+        std::cerr << "Error: '" << name << "' ended before its last mip level\n";
+        return false;
+    }
+
+    return true;
+}
+
+int CompressedImage::level_width(int level) const
+{
+    return std::max(m_width >> level, 1);
+}
+
+int CompressedImage::level_height(int level) const
+{
+    return std::max(m_height >> level, 1);
+}
+
+size_t CompressedImage::level_size(int level) const
+{
+    auto block_size = m_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || m_format == GL_COMPRESSED_RGB8_ETC2 ? 8 : 16;
+    auto blocks_across = static_cast<size_t>(level_width(level) + 3) / 4;
+    auto blocks_down = static_cast<size_t>(level_height(level) + 3) / 4;
+    return blocks_across * blocks_down * block_size;
+}
+
+bool CompressedImage::is_supported() const
+{
+#ifdef WEBASSEMBLY
+    // ETC2 and EAC are core in WebGL 2
+    return is_etc_format(m_format);
+#else
+    if (m_format == GL_COMPRESSED_RG_RGTC2) {
+        return GLEW_ARB_texture_compression_rgtc;
+    }
+
+    if (is_bc_format(m_format)) {
+        return GLEW_EXT_texture_compression_s3tc;
+    }
+
+    return GLEW_ARB_ES3_compatibility;
+#endif
+}
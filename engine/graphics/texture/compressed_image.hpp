@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Engine {
+
+// An image transcoded by tools/texture_compressor.py into GPU block
+// compressed data, BCn on desktop or ETC2 on the web, along with its
+// whole mip chain. Stored as a KTX (version 1) file, so the blocks can be
+// handed straight to the driver without decoding.
+class CompressedImage {
+public:
+    struct Level {
+        int index;
+        int width;
+        int height;
+        std::vector<uint8_t> data;
+    };
+
+    // The compressed version of an image, e.g. "/textures/wood/wood.ktx"
+    static std::string name_for(std::string_view image_name);
+
+    // Reads the header and every level
+    static bool read(std::istream&, std::string_view name, CompressedImage&);
+
+    // Reads just the header, leaving the stream at the first level
+    static bool read_header(std::istream&, std::string_view name, CompressedImage&);
+
+    // Reads levels first to end, from a stream left by read_header. Earlier
+    // levels are skipped over without being read.
+    bool read_levels(std::istream&, std::string_view name, int first, int end);
+
+    // Whether the driver can sample this image's format
+    [[nodiscard]] bool is_supported() const;
+
+    [[nodiscard]] inline uint32_t format() const { return m_format; }
+    [[nodiscard]] inline int width() const { return m_width; }
+    [[nodiscard]] inline int height() const { return m_height; }
+    [[nodiscard]] inline int level_count() const { return m_level_count; }
+
+    // Only the levels that have been read
+    [[nodiscard]] inline std::vector<Level> const& levels() const { return m_levels; }
+
+    [[nodiscard]] int level_width(int level) const;
+    [[nodiscard]] int level_height(int level) const;
+    [[nodiscard]] size_t level_size(int level) const;
+
+private:
+    uint32_t m_format { 0 };
+    int m_width { 0 };
+    int m_height { 0 };
+    int m_level_count { 0 };
+    std::vector<Level> m_levels;
+};
+
+}
@@ -7,6 +7,7 @@
 #include "cube_map_texture.hpp"
 #include "engine/assets/asset_repository.hpp"
 #include "engine/assets/thread_pool.hpp"
+#include "texture_uploader.hpp"
 #include <GL/glew.h>
 #include <array>
 #include <cstdint>
@@ -17,10 +18,6 @@
 #include <tuple>
 using namespace Engine;
 
-#ifdef WIN32
-#include <Windows.h>
-#endif
-
 constexpr std::array s_face_names = {
     "positive_x",
     "negative_x",
@@ -77,19 +74,29 @@ std::shared_ptr<CubeMapTexture> CubeMapTexture::construct(AssetRepository const&
 
         auto texture = texture_weak.lock();
         if (!texture) {
+            for (auto const& [data, width, height] : faces) {
+                stbi_image_free(data);
+            }
             return;
         }
 
-        texture->m_data = faces;
+        size_t size = 0;
+        for (auto const& [data, width, height] : faces) {
+            size += static_cast<size_t>(width) * height * 3;
+        }
+
+        auto upload = std::make_unique<TextureUploader::Upload>(texture_weak, GL_TEXTURE_CUBE_MAP, size);
+        for (int i = 0; i < faces.size(); i++) {
+            auto const& [data, width, height] = faces[i];
+            upload->add_image(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, width, height, GL_RGB, data);
+            stbi_image_free(data);
+        }
 
-#ifdef WIN32
-        WaitForSingleObject(texture->m_loader_thread_mutex, INFINITE);
-        texture->m_has_data_loaded = true;
-        ReleaseMutex(texture->m_loader_thread_mutex);
-#else
-        std::lock_guard<std::mutex> const guard(texture->m_loader_thread_mutex);
-        texture->m_has_data_loaded = true;
-#endif
+        // Only called while the texture's still around
+        upload->on_uploaded([texture = texture.get()] {
+            texture->m_has_loaded = true;
+        });
+        TextureUploader::queue(std::move(upload));
     });
 
     return texture;
@@ -99,29 +106,4 @@ void CubeMapTexture::bind(int slot) const
 {
     glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(GL_TEXTURE_CUBE_MAP, m_texture);
-
-    if (m_has_loaded) {
-        return;
-    }
-
-#ifdef WIN32
-    WaitForSingleObject(m_loader_thread_mutex, INFINITE);
-#else
-    std::lock_guard<std::mutex> guard(m_loader_thread_mutex);
-#endif
-
-    if (m_has_data_loaded) {
-        for (int i = 0; i < m_data.size(); i++) {
-            auto const& [data, width, height] = m_data[i];
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        m_data.clear();
-        m_has_loaded = true;
-    }
-
-#ifdef WIN32
-    ReleaseMutex(m_loader_thread_mutex);
-#endif
 }
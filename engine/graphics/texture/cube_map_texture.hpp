@@ -9,7 +9,6 @@
 #include "engine/forward.hpp"
 #include "texture.hpp"
 #include <memory>
-#include <vector>
 
 namespace Engine {
 
@@ -24,8 +23,6 @@ private:
         : Texture(texture)
     {
     }
-
-    mutable std::vector<std::tuple<uint8_t*, int, int>> m_data;
 };
 
 }
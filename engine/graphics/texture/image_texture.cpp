@@ -10,17 +10,17 @@
 #include "engine/assets/asset_repository.hpp"
 #include "engine/assets/thread_pool.hpp"
 #include "image_texture.hpp"
+#include "texture_streamer.hpp"
+#include "texture_uploader.hpp"
 #include <GL/glew.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <vector>
 using namespace Engine;
 
-#ifdef WIN32
-#include <Windows.h>
-#endif
-
 std::map<std::string, std::weak_ptr<ImageTexture>> s_loaded_textures;
 
 std::shared_ptr<ImageTexture> ImageTexture::construct(AssetRepository const& assets, std::string_view name)
@@ -45,10 +45,24 @@ std::shared_ptr<ImageTexture> ImageTexture::construct(AssetRepository const& ass
     auto texture = std::shared_ptr<ImageTexture>(new ImageTexture(texture_id));
     auto texture_weak = std::weak_ptr<ImageTexture>(texture);
     texture->m_name = name;
+    texture->m_assets = assets.copy();
     s_loaded_textures.insert(std::make_pair(std::string(name), texture));
+    TextureStreamer::add(texture);
 
     ThreadPool::queue_task([assets = assets.copy(), name = std::string(name), texture_weak]() {
-        auto stream = std::move(assets->open(name));
+#ifdef COMPRESSED_TEXTURES
+        if (load_compressed(*assets, name, texture_weak)) {
+            return;
+        }
+#endif
+
+        // Web builds only embed the compressed copy
+        auto stream = assets->open(name);
+        if (!stream) {
+            std::cerr << "Error: Unable to open texture " << name << "\n";
+            return;
+        }
+
         stream->seekg(0, std::ios::end);
         auto size = static_cast<long>(stream->tellg());
         stream->seekg(0, std::ios::beg);
@@ -73,51 +87,174 @@ std::shared_ptr<ImageTexture> ImageTexture::construct(AssetRepository const& ass
 
         auto texture = texture_weak.lock();
         if (!texture) {
+            stbi_image_free(data);
             return;
         }
 
-        texture->m_data = data;
-        texture->m_width = width;
-        texture->m_height = height;
-
-#ifdef WIN32
-        WaitForSingleObject(texture->m_loader_thread_mutex, INFINITE);
-        texture->m_has_data_loaded = true;
-        ReleaseMutex(texture->m_loader_thread_mutex);
-#else
-        std::lock_guard<std::mutex> guard(texture->m_loader_thread_mutex);
-        texture->m_has_data_loaded = true;
-#endif
+        auto upload = std::make_unique<TextureUploader::Upload>(texture_weak, GL_TEXTURE_2D, static_cast<size_t>(width) * height * 4);
+        upload->add_image(GL_TEXTURE_2D, 0, width, height, GL_RGBA, data);
+        upload->generate_mipmap();
+        stbi_image_free(data);
+
+        // Only called while the texture's still around
+        upload->on_uploaded([texture = texture.get()] {
+            texture->m_has_loaded = true;
+        });
+        TextureUploader::queue(std::move(upload));
     });
 
     return texture;
 }
 
-void ImageTexture::bind(int slot) const
+// Stages every level the image has, to be uploaded together
+static std::unique_ptr<TextureUploader::Upload> stage_levels(std::weak_ptr<ImageTexture> const& texture, CompressedImage const& image)
+{
+    size_t size = 0;
+    for (auto const& level : image.levels()) {
+        size += level.data.size();
+    }
+
+    auto upload = std::make_unique<TextureUploader::Upload>(texture, GL_TEXTURE_2D, size);
+    for (auto const& level : image.levels()) {
+        upload->add_compressed_image(GL_TEXTURE_2D, level.index, level.width, level.height,
+            image.format(), level.data.data(), level.data.size());
+    }
+
+    return upload;
+}
+
+bool ImageTexture::load_compressed(AssetRepository const& assets, std::string const& name, std::weak_ptr<ImageTexture> const& texture_weak)
+{
+    auto compressed_name = CompressedImage::name_for(name);
+    auto stream = assets.open(compressed_name);
+    if (!stream) {
+        return false;
+    }
+
+    auto image = std::make_unique<CompressedImage>();
+    if (!CompressedImage::read_header(*stream, compressed_name, *image)) {
+        return false;
+    }
+
+    if (!image->is_supported()) {
+        std::cerr << "Warning: '" << compressed_name << "' is in a format the driver doesn't support, decoding '" << name << "' instead\n";
+        return false;
+    }
+
+    // Only the smallest levels to start with, the rest are streamed in
+    auto first_level = 0;
+    while (first_level < image->level_count() - 1
+        && std::max(image->level_width(first_level), image->level_height(first_level)) > TextureStreamer::initial_size) {
+        first_level += 1;
+    }
+
+    auto header = *image;
+    if (!image->read_levels(*stream, compressed_name, first_level, image->level_count())) {
+        return false;
+    }
+
+    // Already gone, so nothing more to load
+    auto texture = texture_weak.lock();
+    if (!texture) {
+        return true;
+    }
+
+    auto upload = stage_levels(texture_weak, *image);
+    upload->on_uploaded([texture = texture.get(), header = std::move(header), first_level] {
+        texture->m_header = header;
+        texture->on_levels_uploaded(first_level);
+    });
+    TextureUploader::queue(std::move(upload));
+    return true;
+}
+
+void ImageTexture::stream_in(std::shared_ptr<ImageTexture> const& texture, int first_level)
+{
+    texture->m_is_streaming_in = true;
+    texture->m_streaming_level = first_level;
+
+    auto texture_weak = std::weak_ptr<ImageTexture>(texture);
+    auto end_level = texture->m_resident_level;
+    ThreadPool::queue_task([assets = texture->m_assets, name = CompressedImage::name_for(texture->m_name), texture_weak, first_level, end_level]() {
+        auto image = std::make_unique<CompressedImage>();
+        auto stream = assets->open(name);
+        if (!stream || !CompressedImage::read_header(*stream, name, *image) || !image->read_levels(*stream, name, first_level, end_level)) {
+            // Handed over with no levels, so the texture stops asking
+            image = std::make_unique<CompressedImage>();
+        }
+
+        auto texture = texture_weak.lock();
+        if (!texture) {
+            return;
+        }
+
+        auto first_uploaded = image->levels().empty() ? -1 : first_level;
+        auto upload = stage_levels(texture_weak, *image);
+        upload->on_uploaded([texture = texture.get(), first_uploaded] {
+            texture->on_levels_uploaded(first_uploaded);
+        });
+        TextureUploader::queue(std::move(upload));
+    });
+}
+
+void ImageTexture::evict_to(int level)
 {
-    glActiveTexture(GL_TEXTURE0 + slot);
     glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
 
-    if (m_has_loaded) {
+    // Respecifying a level as empty frees it
+    for (int i = m_resident_level; i < level; i++) {
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_resident_level = level;
+}
+
+size_t ImageTexture::size_of_levels(int first, int end) const
+{
+    size_t size = 0;
+    for (int level = first; level < end; level++) {
+        size += m_header.level_size(level);
+    }
+
+    return size;
+}
+
+void ImageTexture::request_detail(float uv_per_pixel) const
+{
+    if (!is_streamed()) {
         return;
     }
 
-#ifdef WIN32
-    WaitForSingleObject(m_loader_thread_mutex, INFINITE);
-#else
-    std::lock_guard<std::mutex> guard(m_loader_thread_mutex);
-#endif
+    // Each level halves the texels, so the one with about one per pixel
+    auto texels_per_pixel = static_cast<float>(std::max(m_header.width(), m_header.height())) * uv_per_pixel;
+    auto level = texels_per_pixel > 1.0f ? static_cast<int>(std::log2(texels_per_pixel)) : 0;
+    level = std::clamp(level, m_finest_level, m_level_count - 1);
 
-    if (m_has_data_loaded) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, m_width, m_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+    m_wanted_level = std::min(m_wanted_level, level);
+    m_last_used_frame = TextureStreamer::frame();
+}
 
-        stbi_image_free(m_data);
-        m_data = nullptr;
-        m_has_loaded = true;
+void ImageTexture::on_levels_uploaded(int first_level)
+{
+    if (!is_streamed()) {
+        m_level_count = m_header.level_count();
+        m_initial_level = first_level;
+        m_resident_level = m_initial_level;
+        m_wanted_level = m_level_count;
+
+        // The file may stop before 1x1, sampling past it would be incomplete
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, m_level_count - 1);
+    } else if (first_level < 0) {
+        // Couldn't be read, so make do with what's there
+        m_finest_level = m_resident_level;
+    } else {
+        m_resident_level = first_level;
     }
 
-#ifdef WIN32
-    ReleaseMutex(m_loader_thread_mutex);
-#endif
+    // Only the resident levels are sampled from
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_resident_level);
+    m_is_streaming_in = false;
+    m_has_loaded = true;
 }
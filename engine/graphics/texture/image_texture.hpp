@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include "compressed_image.hpp"
 #include "engine/forward.hpp"
 #include "texture.hpp"
+#include <cstdint>
+#include <memory>
 #include <string>
 
 namespace Engine {
@@ -16,7 +19,30 @@ class ImageTexture : public Texture {
 public:
     static std::shared_ptr<ImageTexture> construct(AssetRepository const&, std::string_view name);
 
-    virtual void bind(int slot) const final;
+    void request_detail(float uv_per_pixel) const final;
+
+    // Pre-compressed textures are streamed, loading their smallest levels
+    // first and finer ones as they're asked for. See TextureStreamer.
+    [[nodiscard]] inline bool is_streamed() const { return m_level_count > 0; }
+    [[nodiscard]] inline bool is_streaming_in() const { return m_is_streaming_in; }
+    [[nodiscard]] inline int initial_level() const { return m_initial_level; }
+    [[nodiscard]] inline int resident_level() const { return m_resident_level; }
+    [[nodiscard]] inline int wanted_level() const { return m_wanted_level; }
+    [[nodiscard]] inline uint64_t last_used_frame() const { return m_last_used_frame; }
+
+    // In bytes, of levels first to end
+    [[nodiscard]] size_t size_of_levels(int first, int end) const;
+    [[nodiscard]] inline size_t resident_size() const { return size_of_levels(m_resident_level, m_level_count); }
+    [[nodiscard]] inline size_t streaming_size() const { return m_is_streaming_in ? size_of_levels(m_streaming_level, m_resident_level) : 0; }
+
+    // Reads the levels from first up to those already resident on a
+    // loading thread, then queues them to be uploaded
+    static void stream_in(std::shared_ptr<ImageTexture> const&, int first_level);
+
+    // Frees every level finer than the given one
+    void evict_to(int level);
+
+    inline void clear_wanted_level() { m_wanted_level = m_level_count; }
 
 private:
     ImageTexture(int texture)
@@ -24,11 +50,33 @@ private:
     {
     }
 
+    // Reads the smallest levels of the pre-compressed version of the
+    // image, if there's one the driver can use. Called from the loading
+    // thread.
+    static bool load_compressed(AssetRepository const&, std::string const& name, std::weak_ptr<ImageTexture> const&);
+
+    // Takes the levels from first on as resident, or stops asking for
+    // more if none could be read. Called once they've been uploaded.
+    void on_levels_uploaded(int first_level);
+
     std::string m_name;
+    std::shared_ptr<AssetRepository> m_assets;
+
+    // The compressed image's header, with none of its levels
+    CompressedImage m_header;
+
+    // Levels are numbered from the finest, so the resident ones are from
+    // m_resident_level to m_level_count. Zero levels if not streamed.
+    mutable int m_level_count { 0 };
+    mutable int m_initial_level { 0 };
+    mutable int m_resident_level { 0 };
+    mutable int m_finest_level { 0 };
+    mutable int m_streaming_level { 0 };
+    mutable bool m_is_streaming_in { false };
 
-    mutable uint8_t* m_data { nullptr };
-    int m_width { 0 };
-    int m_height { 0 };
+    // What the renderer asked for, since the streamer last ran
+    mutable int m_wanted_level { 0 };
+    mutable uint64_t m_last_used_frame { 0 };
 };
 
 }
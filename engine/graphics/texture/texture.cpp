@@ -8,10 +8,6 @@
 #include <GL/glew.h>
 using namespace Engine;
 
-#ifdef WIN32
-#include <Windows.h>
-#endif
-
 void Texture::unbind(int slot)
 {
     glActiveTexture(GL_TEXTURE0 + slot);
@@ -21,26 +17,6 @@ void Texture::unbind(int slot)
 Texture::Texture(GLuint texture)
     : m_texture(texture)
 {
-#ifdef WIN32
-    m_loader_thread_mutex = CreateMutex(NULL, FALSE, NULL);
-#endif
-}
-
-bool Texture::has_loaded() const
-{
-    if (m_has_loaded) {
-        return true;
-    }
-
-#ifdef WIN32
-    WaitForSingleObject(m_loader_thread_mutex, INFINITE);
-    auto has_loaded = m_has_data_loaded;
-    ReleaseMutex(m_loader_thread_mutex);
-    return has_loaded;
-#else
-    std::lock_guard<std::mutex> const guard(m_loader_thread_mutex);
-    return m_has_data_loaded;
-#endif
 }
 
 void Texture::bind(int slot) const
@@ -52,8 +28,4 @@ void Texture::bind(int slot) const
 Texture::~Texture()
 {
     glDeleteTextures(1, &m_texture);
-
-#ifdef WIN32
-    CloseHandle(m_loader_thread_mutex);
-#endif
 }
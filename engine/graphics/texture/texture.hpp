@@ -6,12 +6,6 @@
 
 #pragma once
 
-#ifdef WIN32
-typedef void* HANDLE;
-#else
-#include <mutex>
-#endif
-
 typedef unsigned int GLuint;
 typedef int GLint;
 
@@ -25,19 +19,20 @@ public:
     virtual ~Texture();
 
     virtual void bind(int slot) const;
-    bool has_loaded() const;
+
+    // Set once its pixels have been uploaded
+    [[nodiscard]] inline bool has_loaded() const { return m_has_loaded; }
+
+    // Asks for enough detail to draw the texture with a screen pixel
+    // covering this much of its UV space, for textures that stream
+    virtual void request_detail(float) const { }
+
+    [[nodiscard]] inline GLuint id() const { return m_texture; }
 
 protected:
     GLuint m_texture;
 
     mutable bool m_has_loaded { false };
-    bool m_has_data_loaded { false };
-
-#ifdef WIN32
-    HANDLE m_loader_thread_mutex { nullptr };
-#else
-    mutable std::mutex m_loader_thread_mutex;
-#endif
 };
 
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "texture_streamer.hpp"
+#include "image_texture.hpp"
+#include <algorithm>
+#include <vector>
+using namespace Engine;
+
+// Enough to keep the loading threads busy, without a burst of uploads
+static constexpr int s_max_streaming_in = 4;
+
+static std::vector<std::weak_ptr<ImageTexture>> s_textures;
+static size_t s_budget = TextureStreamer::default_budget;
+static uint64_t s_frame = 1;
+static TextureStreamer::Stats s_stats {};
+
+void TextureStreamer::add(std::shared_ptr<ImageTexture> const& texture)
+{
+    s_textures.push_back(texture);
+}
+
+void TextureStreamer::set_budget(size_t bytes)
+{
+    s_budget = bytes;
+}
+
+uint64_t TextureStreamer::frame()
+{
+    return s_frame;
+}
+
+TextureStreamer::Stats const& TextureStreamer::stats()
+{
+    return s_stats;
+}
+
+// Has finer levels than it needs. Textures that weren't drawn this frame
+// only need the ones they started with.
+static bool can_evict(ImageTexture const& texture)
+{
+    if (texture.is_streaming_in()) {
+        return false;
+    }
+
+    auto needed_level = texture.last_used_frame() == s_frame ? texture.wanted_level() : texture.initial_level();
+    return texture.resident_level() < std::min(needed_level, texture.initial_level());
+}
+
+// Evicts a level at a time from the least recently used textures, until
+// the size fits in the budget
+static bool make_room(std::vector<std::shared_ptr<ImageTexture>> const& textures, ImageTexture const& for_texture, size_t& resident_size, size_t size)
+{
+    while (resident_size + size > s_budget) {
+        ImageTexture* least_recent = nullptr;
+        for (auto const& texture : textures) {
+            if (texture.get() == &for_texture || !can_evict(*texture)) {
+                continue;
+            }
+
+            if (!least_recent || texture->last_used_frame() < least_recent->last_used_frame()) {
+                least_recent = texture.get();
+            }
+        }
+
+        if (!least_recent) {
+            return false;
+        }
+
+        auto level = least_recent->resident_level();
+        resident_size -= least_recent->size_of_levels(level, level + 1);
+        least_recent->evict_to(level + 1);
+        s_stats.evicted += 1;
+    }
+
+    return true;
+}
+
+void TextureStreamer::update()
+{
+    std::erase_if(s_textures, [](auto const& texture) { return texture.expired(); });
+
+    // Levels being streamed in are counted as if already resident
+    std::vector<std::shared_ptr<ImageTexture>> textures;
+    size_t resident_size = 0;
+    int streaming_in = 0;
+    for (auto const& texture_weak : s_textures) {
+        auto texture = texture_weak.lock();
+        if (!texture->is_streamed()) {
+            continue;
+        }
+
+        resident_size += texture->resident_size() + texture->streaming_size();
+        streaming_in += texture->is_streaming_in() ? 1 : 0;
+        textures.push_back(std::move(texture));
+    }
+
+    // Those furthest from the detail they need go first
+    std::vector<std::shared_ptr<ImageTexture>> wanting;
+    for (auto const& texture : textures) {
+        if (!texture->is_streaming_in() && texture->wanted_level() < texture->resident_level()) {
+            wanting.push_back(texture);
+        }
+    }
+
+    std::stable_sort(wanting.begin(), wanting.end(), [](auto const& a, auto const& b) {
+        return a->resident_level() - a->wanted_level() > b->resident_level() - b->wanted_level();
+    });
+
+    s_stats.evicted = 0;
+    for (auto const& texture : wanting) {
+        if (streaming_in >= s_max_streaming_in) {
+            break;
+        }
+
+        // Settle for less detail if all of it doesn't fit
+        for (int level = texture->wanted_level(); level < texture->resident_level(); level++) {
+            auto size = texture->size_of_levels(level, texture->resident_level());
+            if (make_room(textures, *texture, resident_size, size)) {
+                ImageTexture::stream_in(texture, level);
+                resident_size += size;
+                streaming_in += 1;
+                break;
+            }
+        }
+    }
+
+    s_stats.resident_size = resident_size;
+    s_stats.budget = s_budget;
+    s_stats.textures = static_cast<int>(textures.size());
+    s_stats.streaming_in = streaming_in;
+
+    for (auto const& texture : textures) {
+        texture->clear_wanted_level();
+    }
+    s_frame += 1;
+}
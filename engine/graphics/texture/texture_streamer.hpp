@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/forward.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Keeps the mip levels each streamed texture needs resident, within a
+// memory budget. Textures start with just their smallest levels. While
+// drawing, the renderer asks for as much detail as each texture covers
+// on screen, and finer levels are read on the loading threads. When over
+// budget, the least recently used textures give up their finest levels.
+namespace Engine::TextureStreamer {
+
+// Levels at or below this many texels across are loaded up front
+constexpr int initial_size = 64;
+
+constexpr size_t default_budget = 96 * 1024 * 1024;
+
+struct Stats {
+    size_t resident_size;
+    size_t budget;
+    int textures;
+    int streaming_in;
+    int evicted;
+};
+
+void add(std::shared_ptr<ImageTexture> const&);
+void set_budget(size_t bytes);
+
+// Counts up once per update, for telling which textures were used recently
+uint64_t frame();
+
+// Once a frame, after rendering. Streams in or evicts levels to fit what
+// was asked for, levels streamed in are uploaded by TextureUploader.
+void update();
+
+Stats const& stats();
+
+}
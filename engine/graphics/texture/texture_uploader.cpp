@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "texture_uploader.hpp"
+#include "texture.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iostream>
+using namespace Engine;
+using namespace TextureUploader;
+
+#ifdef WIN32
+
+#include <Windows.h>
+
+static HANDLE s_mutex;
+
+class WindowsMutexGuard {
+public:
+    WindowsMutexGuard(HANDLE mutex)
+        : m_mutex(mutex)
+    {
+        WaitForSingleObject(mutex, INFINITE);
+    }
+
+    ~WindowsMutexGuard()
+    {
+        ReleaseMutex(m_mutex);
+    }
+
+private:
+    HANDLE m_mutex;
+};
+
+#define MUTEX_GUARD(mutex) \
+    WindowsMutexGuard guard(mutex)
+
+#else
+
+#include <mutex>
+
+static std::mutex s_mutex;
+
+#define MUTEX_GUARD(_mutex) \
+    std::lock_guard<std::mutex> guard(_mutex)
+
+#endif
+
+static constexpr size_t s_not_staged = static_cast<size_t>(-1);
+
+// Offsets into the pixel buffer, enough for any pixel type
+static constexpr size_t s_staging_alignment = 16;
+
+// A range of the pixel buffer, freed once the GPU has finished reading
+// it. Ranges are handed out in a ring, so they're freed in that order.
+struct Region {
+    size_t begin;
+    size_t end;
+    bool is_released;
+    GLsync fence;
+};
+
+// Everything below is guarded by the mutex, other than the buffer itself
+static GLuint s_buffer = 0;
+static uint8_t* s_mapped = nullptr;
+static std::deque<Region> s_regions;
+static std::deque<std::unique_ptr<Upload>> s_queue;
+
+static float s_budget_ms = default_budget_ms;
+static Stats s_stats {};
+static double s_total_latency_ms = 0;
+
+static size_t allocate_region(size_t size)
+{
+    if (!s_mapped || size == 0 || size > staging_size) {
+        return s_not_staged;
+    }
+
+    size = (size + s_staging_alignment - 1) / s_staging_alignment * s_staging_alignment;
+
+    size_t begin = 0;
+    if (!s_regions.empty()) {
+        auto tail = s_regions.front().begin;
+        auto head = s_regions.back().end;
+        auto has_wrapped = s_regions.back().begin < tail;
+        if (has_wrapped) {
+            if (tail - head < size) {
+                return s_not_staged;
+            }
+            begin = head;
+        } else if (staging_size - head >= size) {
+            begin = head;
+        } else if (tail >= size) {
+            begin = 0;
+        } else {
+            return s_not_staged;
+        }
+    }
+
+    s_regions.push_back(Region { begin, begin + size, false, nullptr });
+    return begin;
+}
+
+static void release_region(size_t begin, GLsync fence)
+{
+    for (auto& region : s_regions) {
+        if (region.begin == begin && !region.is_released) {
+            region.is_released = true;
+            region.fence = fence;
+            return;
+        }
+    }
+}
+
+// Frees the oldest ranges the GPU is done with. Called on the render thread.
+static void retire_regions()
+{
+    while (!s_regions.empty() && s_regions.front().is_released) {
+        auto fence = s_regions.front().fence;
+        if (fence) {
+            auto status = glClientWaitSync(fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                return;
+            }
+            glDeleteSync(fence);
+        }
+
+        s_regions.pop_front();
+    }
+}
+
+Upload::Upload(std::weak_ptr<Texture const> texture, GLenum bind_target, size_t size)
+    : m_texture(std::move(texture))
+    , m_bind_target(bind_target)
+    , m_staging_size(size)
+{
+    MUTEX_GUARD(s_mutex);
+    m_staging_offset = allocate_region(size);
+    if (m_staging_offset == s_not_staged) {
+        m_pixels.reserve(size);
+    }
+}
+
+Upload::~Upload()
+{
+    // Never uploaded, so nothing's reading the range
+    if (m_staging_offset != s_not_staged) {
+        MUTEX_GUARD(s_mutex);
+        release_region(m_staging_offset, nullptr);
+    }
+}
+
+void Upload::unstage()
+{
+    m_pixels.assign(s_mapped + m_staging_offset, s_mapped + m_staging_offset + m_size);
+
+    MUTEX_GUARD(s_mutex);
+    release_region(m_staging_offset, nullptr);
+    m_staging_offset = s_not_staged;
+}
+
+uint8_t* Upload::reserve(size_t size)
+{
+    // Ran past what was reserved, so carry on in client memory
+    if (m_staging_offset != s_not_staged && m_size + size > m_staging_size) {
+        unstage();
+    }
+
+    auto offset = m_size;
+    m_size += size;
+    if (m_staging_offset != s_not_staged) {
+        return s_mapped + m_staging_offset + offset;
+    }
+
+    m_pixels.resize(m_size);
+    return m_pixels.data() + offset;
+}
+
+void Upload::add_image(GLenum target, int level, int width, int height, GLenum format, uint8_t const* pixels)
+{
+    auto channels = format == GL_RGBA ? 4 : 3;
+    auto size = static_cast<size_t>(width) * height * channels;
+    auto* staged = reserve(size);
+    m_images.push_back(Image { target, level, width, height, format, false, m_size - size, size });
+    std::memcpy(staged, pixels, size);
+}
+
+void Upload::add_compressed_image(GLenum target, int level, int width, int height, GLenum format, uint8_t const* data, size_t size)
+{
+    auto* staged = reserve(size);
+    m_images.push_back(Image { target, level, width, height, format, true, m_size - size, size });
+    std::memcpy(staged, data, size);
+}
+
+size_t Upload::upload()
+{
+    // Gone before its turn came
+    auto texture = m_texture.lock();
+    if (!texture) {
+        return 0;
+    }
+
+    // Staged pixels are read from the bound buffer, by offset
+    auto is_staged = m_staging_offset != s_not_staged;
+    if (is_staged) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_buffer);
+    }
+
+    glBindTexture(m_bind_target, texture->id());
+    for (auto const& image : m_images) {
+        auto const* pixels = is_staged
+            ? reinterpret_cast<void const*>(m_staging_offset + image.offset)
+            : m_pixels.data() + image.offset;
+
+        if (image.is_compressed) {
+            glCompressedTexImage2D(image.target, image.level, image.format,
+                image.width, image.height, 0, static_cast<GLsizei>(image.size), pixels);
+        } else {
+            glTexImage2D(image.target, image.level, static_cast<GLint>(image.format),
+                image.width, image.height, 0, image.format, GL_UNSIGNED_BYTE, pixels);
+        }
+    }
+
+    if (is_staged) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        // The range is free to reuse once the GPU has copied out of it
+        auto fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        MUTEX_GUARD(s_mutex);
+        release_region(m_staging_offset, fence);
+        m_staging_offset = s_not_staged;
+    }
+
+    if (m_generate_mipmap) {
+        glGenerateMipmap(m_bind_target);
+    }
+    if (m_on_uploaded) {
+        m_on_uploaded();
+    }
+
+    glBindTexture(m_bind_target, 0);
+    return m_size;
+}
+
+// WebGL can't map buffers, so everything's uploaded from client memory there
+void TextureUploader::init()
+{
+#ifdef WIN32
+    s_mutex = CreateMutex(NULL, FALSE, NULL);
+#endif
+
+#ifndef WEBASSEMBLY
+    if (!GLEW_ARB_buffer_storage) {
+        std::cerr << "Warning: Persistently mapped buffers aren't supported, uploading textures from client memory\n";
+        return;
+    }
+
+    auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &s_buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, staging_size, nullptr, flags);
+    auto* mapped = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, staging_size, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (!mapped) {
+        std::cerr << "Warning: Unable to map the texture staging buffer, uploading textures from client memory\n";
+        glDeleteBuffers(1, &s_buffer);
+        s_buffer = 0;
+        return;
+    }
+
+    MUTEX_GUARD(s_mutex);
+    s_mapped = mapped;
+#endif
+}
+
+void TextureUploader::queue(std::unique_ptr<Upload> upload)
+{
+    upload->m_queued_at = std::chrono::steady_clock::now();
+
+    MUTEX_GUARD(s_mutex);
+    s_queue.push_back(std::move(upload));
+}
+
+void TextureUploader::set_budget(float milliseconds)
+{
+    s_budget_ms = milliseconds;
+}
+
+TextureUploader::Stats const& TextureUploader::stats()
+{
+    return s_stats;
+}
+
+void TextureUploader::update()
+{
+    using Milliseconds = std::chrono::duration<float, std::milli>;
+    auto start = std::chrono::steady_clock::now();
+    s_stats.uploaded = 0;
+    s_stats.uploaded_size = 0;
+
+    {
+        MUTEX_GUARD(s_mutex);
+        retire_regions();
+    }
+
+    for (;;) {
+        std::unique_ptr<Upload> upload;
+        {
+            MUTEX_GUARD(s_mutex);
+            if (s_queue.empty()) {
+                break;
+            }
+
+            upload = std::move(s_queue.front());
+            s_queue.pop_front();
+        }
+
+        auto is_staged = upload->m_staging_offset != s_not_staged;
+        auto size = upload->upload();
+        auto now = std::chrono::steady_clock::now();
+        if (size > 0) {
+            auto latency = Milliseconds(now - upload->m_queued_at).count();
+            s_total_latency_ms += latency;
+            s_stats.max_latency_ms = std::max(s_stats.max_latency_ms, latency);
+            s_stats.total_uploaded += 1;
+            s_stats.unstaged += is_staged ? 0 : 1;
+            s_stats.uploaded += 1;
+            s_stats.uploaded_size += size;
+        }
+
+        if (Milliseconds(now - start).count() >= s_budget_ms) {
+            break;
+        }
+    }
+
+    if (s_stats.total_uploaded > 0) {
+        s_stats.average_latency_ms = static_cast<float>(s_total_latency_ms / s_stats.total_uploaded);
+    }
+    s_stats.upload_ms = Milliseconds(std::chrono::steady_clock::now() - start).count();
+
+    MUTEX_GUARD(s_mutex);
+    s_stats.queued = static_cast<int>(s_queue.size());
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/forward.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+typedef unsigned int GLenum;
+
+// Keeps texture uploads out of the draw loop. The loading threads copy
+// decoded pixels straight into a persistently mapped pixel buffer, then
+// once a frame the render thread uploads from it until its time budget
+// is spent. Where the buffer can't be mapped, as on WebGL, or is full,
+// the pixels wait in client memory and are uploaded from there instead.
+namespace Engine::TextureUploader {
+
+constexpr float default_budget_ms = 2.0f;
+constexpr size_t staging_size = 48 * 1024 * 1024;
+
+struct Stats {
+    int queued;
+    int uploaded;
+    size_t uploaded_size;
+    float upload_ms;
+
+    // From being queued to being uploaded, over every upload so far
+    int total_uploaded;
+    int unstaged;
+    float average_latency_ms;
+    float max_latency_ms;
+};
+
+// Images of one texture, uploaded together. Built on a loading thread.
+class Upload {
+    friend void queue(std::unique_ptr<Upload>);
+    friend void update();
+
+public:
+    // Reserves the given total size of staging memory for the images
+    Upload(std::weak_ptr<Texture const>, GLenum bind_target, size_t size);
+    ~Upload();
+
+    Upload(Upload const&) = delete;
+    Upload& operator=(Upload const&) = delete;
+
+    // Uncompressed images have 8 bits per channel
+    void add_image(GLenum target, int level, int width, int height, GLenum format, uint8_t const* pixels);
+    void add_compressed_image(GLenum target, int level, int width, int height, GLenum format, uint8_t const* data, size_t size);
+
+    inline void generate_mipmap() { m_generate_mipmap = true; }
+
+    // Run on the render thread once uploaded, with the texture still bound
+    inline void on_uploaded(std::function<void()> callback) { m_on_uploaded = std::move(callback); }
+
+private:
+    struct Image {
+        GLenum target;
+        int level;
+        int width;
+        int height;
+        GLenum format;
+        bool is_compressed;
+        size_t offset;
+        size_t size;
+    };
+
+    uint8_t* reserve(size_t size);
+    void unstage();
+
+    // Returns the size uploaded, nothing if the texture's gone
+    size_t upload();
+
+    std::weak_ptr<Texture const> m_texture;
+    GLenum m_bind_target;
+    std::vector<Image> m_images;
+    bool m_generate_mipmap { false };
+    std::function<void()> m_on_uploaded;
+
+    // Offset into the pixel buffer, or client memory if it didn't fit
+    size_t m_staging_offset;
+    size_t m_staging_size;
+    std::vector<uint8_t> m_pixels;
+    size_t m_size { 0 };
+
+    std::chrono::steady_clock::time_point m_queued_at;
+};
+
+// Maps the pixel buffer, on the render thread before any textures load
+void init();
+
+// Called from the loading threads
+void queue(std::unique_ptr<Upload>);
+
+void set_budget(float milliseconds);
+
+// Once a frame, before rendering. Always uploads at least one texture,
+// so ones that take longer than the budget still get through.
+void update();
+
+Stats const& stats();
+
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "uniform_buffer.hpp"
+#include <GL/glew.h>
+#include <cassert>
+using namespace Engine;
+
+std::shared_ptr<UniformBuffer> UniformBuffer::construct(GLuint binding, size_t size)
+{
+    auto buffer = std::shared_ptr<UniformBuffer>(new UniformBuffer());
+    buffer->m_binding = binding;
+    buffer->m_size = size;
+
+    glGenBuffers(1, &buffer->m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer->m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return buffer;
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &m_buffer);
+}
+
+void UniformBuffer::bind() const
+{
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_buffer);
+}
+
+void UniformBuffer::upload(void const* data, size_t size, size_t offset)
+{
+    assert(offset + size <= m_size);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+typedef unsigned int GLuint;
+
+namespace Engine {
+
+// A block of uniforms shared by every draw, attached to a fixed binding
+// point. Contents must follow the block's std140 layout.
+class UniformBuffer {
+public:
+    static std::shared_ptr<UniformBuffer> construct(GLuint binding, size_t size);
+    ~UniformBuffer();
+
+    // Attaches the buffer to its binding point
+    void bind() const;
+    void upload(void const* data, size_t size, size_t offset = 0);
+
+    [[nodiscard]] inline GLuint binding() const { return m_binding; }
+    [[nodiscard]] inline size_t size() const { return m_size; }
+
+private:
+    UniformBuffer() = default;
+
+    GLuint m_buffer { 0 };
+    GLuint m_binding { 0 };
+    size_t m_size { 0 };
+};
+
+}
@@ -7,6 +7,10 @@
 #ifdef LOGGER_ENABLED
 
 #include "logger.hpp"
+#include "engine/graphics/renderer/render_queue.hpp"
+#include "engine/graphics/texture/texture_streamer.hpp"
+#include "engine/graphics/texture/texture_uploader.hpp"
+#include "gameobject/slab_pool.hpp"
 #include <vector>
 #include <chrono>
 #include <iostream>
@@ -30,6 +34,12 @@ float find_percentage(system_clock::duration time)
 	return (float)duration_cast<milliseconds>(time).count() / 16.0f * 100.0f;
 }
 
+void Logger::on_model_optimized(std::string_view name, MeshOptimizer::Stats const& stats)
+{
+	std::cout << "Optimised " << name << ": " << stats.vertices_before << " -> " << stats.vertices_after
+		<< " vertices, ACMR " << stats.acmr_before() << " -> " << stats.acmr_after() << "\n";
+}
+
 void Logger::on_frame_end()
 {
 	auto now = system_clock::now();
@@ -44,6 +54,31 @@ void Logger::on_frame_end()
 		std::cout << "Max frame time: " << find_percentage(*std::max_element(s_frames.begin(), s_frames.end())) << "%\n";
 		std::cout << "Min frame time: " << find_percentage(*std::min_element(s_frames.begin(), s_frames.end())) << "%\n";
 		std::cout << "Dropped frames : " << std::max(60 - (long long)s_frames.size(), 0ll) << "\n";
+		Object::SlabPool::for_each([](Object::SlabPool const& pool)
+		{
+			auto const& stats = pool.stats();
+			std::cout << "Pool " << pool.name() << ": " << stats.live_objects << " live, "
+				<< stats.peak_objects << " peak, " << stats.slabs << " slabs, "
+				<< stats.allocations << " allocations, " << stats.frees << " frees\n";
+		});
+		RenderQueue::for_each([](RenderQueue const& queue)
+		{
+			auto const& requested = queue.requested();
+			auto const& issued = queue.issued();
+			std::cout << "Render queue " << queue.name() << ": " << issued.draws << " draws in "
+				<< issued.draw_calls << " calls, " << issued.state_changes() << " state changes ("
+				<< requested.state_changes() << " without the queue), "
+				<< issued.texture_binds << " texture binds, " << issued.mesh_binds << " mesh binds\n";
+		});
+		auto const& streaming = TextureStreamer::stats();
+		std::cout << "Texture streaming: " << streaming.resident_size / 1024 << " of " << streaming.budget / 1024
+			<< " KiB resident over " << streaming.textures << " textures, " << streaming.streaming_in
+			<< " streaming in, " << streaming.evicted << " levels evicted\n";
+		auto const& uploads = TextureUploader::stats();
+		std::cout << "Texture uploads: " << uploads.uploaded << " (" << uploads.uploaded_size / 1024 << " KiB) in "
+			<< uploads.upload_ms << "ms last frame, " << uploads.queued << " queued, " << uploads.total_uploaded
+			<< " total (" << uploads.unstaged << " unstaged), latency " << uploads.average_latency_ms << "ms average, "
+			<< uploads.max_latency_ms << "ms max\n";
 		std::cout << "==========================================\n\n";
 		s_frames.clear();
 	}
@@ -6,6 +6,9 @@
 
 #pragma once
 
+#include "engine/graphics/mesh/mesh_optimizer.hpp"
+#include <string_view>
+
 // #define LOGGER_ENABLED
 
 namespace Engine::Logger {
@@ -14,11 +17,13 @@ namespace Engine::Logger {
 
 void on_frame_start();
 void on_frame_end();
+void on_model_optimized(std::string_view name, MeshOptimizer::Stats const&);
 
 #else
 
 inline void on_frame_start() { }
 inline void on_frame_end() { }
+inline void on_model_optimized(std::string_view, MeshOptimizer::Stats const&) { }
 
 #endif
 
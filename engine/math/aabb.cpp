@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "aabb.hpp"
+using namespace Engine;
+
+AABB AABB::transformed(glm::mat4 const& transform) const
+{
+    if (is_empty()) {
+        return *this;
+    }
+
+    // Each axis of the new extent is the sum of every old axis projected
+    // onto it, rather than transforming all eight corners
+    auto center = glm::vec3(transform * glm::vec4(this->center(), 1));
+    auto linear = glm::mat3(transform);
+    auto absolute = glm::mat3(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+    auto extent = absolute * this->extent();
+    return AABB { center - extent, center + extent };
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <limits>
+
+namespace Engine {
+
+// Axis aligned bounding box. Starts out empty, with min above max, so
+// extending it by anything gives that thing's bounds.
+struct AABB {
+    glm::vec3 min { std::numeric_limits<float>::infinity() };
+    glm::vec3 max { -std::numeric_limits<float>::infinity() };
+
+    [[nodiscard]] inline bool is_empty() const { return min.x > max.x; }
+    [[nodiscard]] inline glm::vec3 center() const { return (min + max) * 0.5f; }
+    [[nodiscard]] inline glm::vec3 extent() const { return (max - min) * 0.5f; }
+
+    inline void extend(glm::vec3 point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    inline void extend(AABB const& other)
+    {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    // The smallest box holding this one once transformed
+    [[nodiscard]] AABB transformed(glm::mat4 const&) const;
+};
+
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "affine.hpp"
+
+#if defined(__SSE2__) && !defined(WEBASSEMBLY)
+#define AFFINE_USE_SSE
+#include <emmintrin.h>
+#endif
+
+using namespace Engine;
+
+static glm::mat3 rotation_matrix(glm::quat q)
+{
+    auto xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    auto xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    auto wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    // Column major, as glm
+    return glm::mat3(
+        glm::vec3(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy)),
+        glm::vec3(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx)),
+        glm::vec3(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy)));
+}
+
+Affine Affine::identity()
+{
+    return Affine { {
+        { 1, 0, 0, 0 },
+        { 0, 1, 0, 0 },
+        { 0, 0, 1, 0 },
+    } };
+}
+
+Affine Affine::from(glm::vec3 position, glm::quat rotation, glm::vec3 scale)
+{
+    auto r = rotation_matrix(rotation);
+
+    Affine affine;
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++) {
+            affine.rows[row][column] = r[column][row] * scale[column];
+        }
+        affine.rows[row][3] = position[row];
+    }
+
+    return affine;
+}
+
+Affine Affine::inverse_of(glm::vec3 position, glm::quat inverse_rotation, glm::vec3 scale)
+{
+    auto r = rotation_matrix(inverse_rotation);
+
+    Affine affine;
+    for (int row = 0; row < 3; row++) {
+        auto inverse_scale = 1.0f / scale[row];
+        auto translation = 0.0f;
+        for (int column = 0; column < 3; column++) {
+            affine.rows[row][column] = r[column][row] * inverse_scale;
+            translation -= affine.rows[row][column] * position[column];
+        }
+        affine.rows[row][3] = translation;
+    }
+
+    return affine;
+}
+
+Affine Affine::operator*(Affine const& other) const
+{
+    Affine result;
+
+#ifdef AFFINE_USE_SSE
+    auto b0 = _mm_load_ps(other.rows[0]);
+    auto b1 = _mm_load_ps(other.rows[1]);
+    auto b2 = _mm_load_ps(other.rows[2]);
+    auto const translation_mask = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    for (int row = 0; row < 3; row++) {
+        auto a = _mm_load_ps(rows[row]);
+        auto r = _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 0, 0)), b0);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)), b1));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 2, 2)), b2));
+
+        // The missing bottom row is (0, 0, 0, 1), so only adds our translation
+        r = _mm_add_ps(r, _mm_and_ps(a, translation_mask));
+        _mm_store_ps(result.rows[row], r);
+    }
+#else
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 4; column++) {
+            result.rows[row][column] = rows[row][0] * other.rows[0][column]
+                + rows[row][1] * other.rows[1][column]
+                + rows[row][2] * other.rows[2][column];
+        }
+        result.rows[row][3] += rows[row][3];
+    }
+#endif
+
+    return result;
+}
+
+glm::mat4 Affine::to_mat4() const
+{
+    return glm::mat4(
+        glm::vec4(rows[0][0], rows[1][0], rows[2][0], 0),
+        glm::vec4(rows[0][1], rows[1][1], rows[2][1], 0),
+        glm::vec4(rows[0][2], rows[1][2], rows[2][2], 0),
+        glm::vec4(rows[0][3], rows[1][3], rows[2][3], 1));
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Engine {
+
+// A 4x4 transform without its constant bottom row, stored as three rows
+// so each one fits in a single SSE register.
+struct alignas(16) Affine {
+    float rows[3][4];
+
+    static Affine identity();
+
+    // Same as translate * rotate * scale
+    static Affine from(glm::vec3 position, glm::quat rotation, glm::vec3 scale);
+
+    // Same as scale(1 / scale) * rotate(inverse_rotation) * translate(-position)
+    static Affine inverse_of(glm::vec3 position, glm::quat inverse_rotation, glm::vec3 scale);
+
+    Affine operator*(Affine const&) const;
+
+    [[nodiscard]] glm::mat4 to_mat4() const;
+};
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "frustum.hpp"
+#include <cmath>
+
+#if defined(__SSE2__) && !defined(WEBASSEMBLY)
+#define FRUSTUM_USE_SSE
+#include <emmintrin.h>
+#endif
+
+using namespace Engine;
+
+Frustum Frustum::from(glm::mat4 const& view_projection)
+{
+    // Rows of the matrix, glm is column major
+    auto row = [&](int i) {
+        return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+
+    glm::vec4 const planes[8] = {
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) + row(1),
+        row(3) - row(1),
+        row(3) + row(2),
+        row(3) - row(2),
+        glm::vec4(0, 0, 0, 1),
+        glm::vec4(0, 0, 0, 1),
+    };
+
+    Frustum frustum;
+    for (int i = 0; i < 8; i++) {
+        frustum.m_x[i] = planes[i].x;
+        frustum.m_y[i] = planes[i].y;
+        frustum.m_z[i] = planes[i].z;
+        frustum.m_w[i] = planes[i].w;
+    }
+
+    return frustum;
+}
+
+Frustum::Containment Frustum::test(AABB const& box) const
+{
+    if (box.is_empty()) {
+        return Containment::Outside;
+    }
+
+    // Against each plane, the box's center is at distance d and the box
+    // reaches r either side of it
+    auto center = box.center();
+    auto extent = box.extent();
+    bool intersects = false;
+
+#ifdef FRUSTUM_USE_SSE
+    auto const sign_mask = _mm_set1_ps(-0.0f);
+    auto cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+    auto ex = _mm_set1_ps(extent.x), ey = _mm_set1_ps(extent.y), ez = _mm_set1_ps(extent.z);
+    for (int i = 0; i < 8; i += 4) {
+        auto px = _mm_load_ps(m_x + i);
+        auto py = _mm_load_ps(m_y + i);
+        auto pz = _mm_load_ps(m_z + i);
+        auto pw = _mm_load_ps(m_w + i);
+
+        auto d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, cx), _mm_mul_ps(py, cy)), _mm_add_ps(_mm_mul_ps(pz, cz), pw));
+        auto r = _mm_add_ps(_mm_add_ps(
+                                _mm_mul_ps(_mm_andnot_ps(sign_mask, px), ex),
+                                _mm_mul_ps(_mm_andnot_ps(sign_mask, py), ey)),
+            _mm_mul_ps(_mm_andnot_ps(sign_mask, pz), ez));
+
+        auto zero = _mm_setzero_ps();
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), zero))) {
+            return Containment::Outside;
+        }
+        if (_mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(d, r), zero))) {
+            intersects = true;
+        }
+    }
+#else
+    for (int i = 0; i < 6; i++) {
+        auto d = m_x[i] * center.x + m_y[i] * center.y + m_z[i] * center.z + m_w[i];
+        auto r = std::abs(m_x[i]) * extent.x + std::abs(m_y[i]) * extent.y + std::abs(m_z[i]) * extent.z;
+        if (d + r < 0) {
+            return Containment::Outside;
+        }
+        if (d - r < 0) {
+            intersects = true;
+        }
+    }
+#endif
+
+    return intersects ? Containment::Intersects : Containment::Inside;
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "aabb.hpp"
+#include <glm/glm.hpp>
+
+namespace Engine {
+
+// The six clip planes of a view projection, laid out so four planes can
+// be tested against a box at once.
+class Frustum {
+public:
+    enum class Containment {
+        Outside,
+        Intersects,
+        Inside,
+    };
+
+    static Frustum from(glm::mat4 const& view_projection);
+
+    [[nodiscard]] Containment test(AABB const&) const;
+
+private:
+    // Two spare planes which every point is in front of pad it out to
+    // two groups of four
+    alignas(16) float m_x[8];
+    alignas(16) float m_y[8];
+    alignas(16) float m_z[8];
+    alignas(16) float m_w[8];
+};
+
+}
@@ -18,7 +18,7 @@
 using namespace Engine;
 using namespace Object;
 
-static std::pair<glm::vec2, glm::vec2> calculate_bounding_box(CollisionShape2D& shape, Transform::Computed2D const& transform)
+static std::pair<glm::vec2, glm::vec2> calculate_bounding_box(CollisionShape2D const& shape, Transform::Computed2D const& transform)
 {
     switch (shape.type()) {
     case CollisionShape2D::Type::AABB: {
@@ -85,26 +85,19 @@ static void resolve_collision(CollisionResolver2D::CollisionObject& lhs, Collisi
 
 void CollisionResolver2D::resolve(Object::World& world)
 {
-    // TODO: This can be cached
     std::vector<CollisionObject> collision_objects;
-    world.for_each([&collision_objects](GameObject& object) {
-        auto colliders = object.get<Collider2D>();
-        if (colliders.empty()) {
+    world.query<Transform, Collider2D>().for_each([&collision_objects](GameObject& object, Transform& transform, Collider2D&) {
+        if (!object.is_active()) {
             return IteratorDecision::Continue;
         }
 
         // Clear collision list
-        for (auto& collider : colliders) {
+        for (auto& collider : object.get<Collider2D>()) {
             collider->m_objects_in_collision_with.clear();
         }
 
-        auto* transform = object.first<Transform>();
-        if (!transform) {
-            return IteratorDecision::Continue;
-        }
-
         auto* body = object.first<PhysicsBody2D>();
-        collision_objects.push_back(CollisionObject { object, *transform, body });
+        collision_objects.push_back(CollisionObject { object, transform, body });
         return IteratorDecision::Continue;
     });
 
@@ -116,8 +109,8 @@ void CollisionResolver2D::resolve(Object::World& world)
                 resolve_collision(lhs, rhs, result);
             }
 
-            lhs_collider.m_objects_in_collision_with.insert(&rhs.object);
-            rhs_collider.m_objects_in_collision_with.insert(&lhs.object);
+            lhs_collider.m_objects_in_collision_with.insert(rhs.object.handle());
+            rhs_collider.m_objects_in_collision_with.insert(lhs.object.handle());
         }
     });
 }
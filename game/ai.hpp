@@ -19,6 +19,13 @@ public:
     void init(Object::GameObject&) override;
     void update(Object::GameObject&, float delta) override;
 
+    struct State {
+        float timer_until_next_action;
+    };
+
+    [[nodiscard]] inline State state() const { return { m_timer_until_next_action }; }
+    inline void restore(State const& state) { m_timer_until_next_action = state.timer_until_next_action; }
+
 private:
     AI(const AI&) = default;
     AI() = default;
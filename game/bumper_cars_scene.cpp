@@ -12,12 +12,15 @@
 #include "engine/assets/thread_pool.hpp"
 #include "engine/graphics/mesh/material.hpp"
 #include "engine/graphics/mesh/mesh_builder.hpp"
+#include "engine/graphics/mesh/static_batcher.hpp"
 #include "engine/graphics/renderer/bloom_renderer.hpp"
 #include "engine/graphics/renderer/sky_box_renderer.hpp"
 #include "engine/graphics/renderer/standard_renderer.hpp"
 #include "engine/graphics/shader.hpp"
 #include "engine/graphics/texture/cube_map_texture.hpp"
 #include "engine/graphics/texture/render_texture.hpp"
+#include "engine/graphics/texture/texture_streamer.hpp"
+#include "engine/graphics/texture/texture_uploader.hpp"
 #include "engine/input.hpp"
 #include "engine/physics/collision_resolver_2d.hpp"
 #include "engine/physics/collision_shape_2d.hpp"
@@ -25,11 +28,13 @@
 #include "gameobject/attributes.hpp"
 #include "gameobject/camera.hpp"
 #include "gameobject/gameobject.hpp"
+#include "gameobject/history.hpp"
 #include "gameobject/light.hpp"
 #include "gameobject/mesh_render.hpp"
 #include "gameobject/physics/box_bounds_3d.hpp"
 #include "gameobject/physics/collider_2d.hpp"
 #include "gameobject/physics/physics_body_2d.hpp"
+#include "gameobject/prefab.hpp"
 #include "gameobject/transform.hpp"
 #include "gameobject/world.hpp"
 #include "in_car_camera.hpp"
@@ -81,6 +86,9 @@ static void on_finished_loading()
 
 #endif
 
+// About five seconds at 60 frames a second
+static constexpr size_t s_history_ticks = 300;
+
 static std::vector<BoxBounds3D::Box> const bounding_boxes = {
     { vec3(27.2268, 2.78474, 0), vec3(1.044855, 4.06174, 32.9089) },
     { vec3(-27.6395, 2.78474, 4.52736), vec3(1.044855, 4.06174, 27.1582) },
@@ -108,19 +116,34 @@ static std::vector<BoxBounds3D::Box> const bounding_boxes = {
 };
 
 BumperCarsScene::BumperCarsScene() = default;
-BumperCarsScene::~BumperCarsScene() = default;
+BumperCarsScene::~BumperCarsScene()
+{
+    if (!m_world) {
+        return;
+    }
+
+    if (m_renderer) {
+        m_world->remove_listener(*m_renderer);
+    }
+    if (m_sky_box_renderer) {
+        m_world->remove_listener(*m_sky_box_renderer);
+    }
+    if (m_history) {
+        m_world->remove_listener(*m_history);
+    }
+}
 
 Object::GameObject* BumperCarsScene::make_cameras(GameObject& player)
 {
     auto& in_car_camera = m_world->add_child();
     in_car_camera.add_component<Transform>();
     in_car_camera.add_component<Camera>();
-    in_car_camera.add_component<InCarCamera>(&player);
+    in_car_camera.add_component<InCarCamera>(player.handle());
 
     auto& look_at_camera = m_world->add_child();
     auto& look_at_camera_transform = look_at_camera.add_component<Transform>();
     look_at_camera.add_component<Camera>();
-    look_at_camera.add_component<LookAtCamera>(&player);
+    look_at_camera.add_component<LookAtCamera>(player.handle());
     look_at_camera_transform.translate(vec3(-27.2537f, 5.0f, -15.7789f));
 
     auto& free_camera = m_world->add_child();
@@ -141,15 +164,23 @@ GameObject* BumperCarsScene::make_bumper_car(AssetRepository const& assets)
     update_loading_status("Loading Object: Bumper Car");
 
     auto* bumper_car = ColladaLoader::open(*m_world, assets, "/models/bumper.dae",
-        [&](Object::GameObject& object, Engine::MeshBuilder& builder, ColladaLoader::ModelMetaData const& meta_data) {
-            object.add_component<MeshRender>(builder.build(), m_renderer, meta_data.material);
+        [&](Object::GameObject& object, ColladaLoader::MeshLevels& levels, ColladaLoader::ModelMetaData const& meta_data) {
+            // There are lots of cars, most of them far off, so each part
+            // gets simpler versions to draw at a distance
+            MeshRender::Lods lods;
+            for (auto const& level : levels) {
+                lods.push_back(level.build());
+            }
+
+            object.add_component<MeshRender>(std::move(lods), m_renderer, meta_data.material);
             object.add_component<Attributes>(meta_data.name);
 
             auto& transform = object.add_component<Transform>();
             transform.set_position(meta_data.translation);
             transform.set_scale(meta_data.scale);
             transform.set_rotation(meta_data.rotation);
-        });
+        },
+        4);
 
     if (!bumper_car) {
         return nullptr;
@@ -171,21 +202,26 @@ GameObject* BumperCarsScene::make_arena(AssetRepository const& assets)
 {
     update_loading_status("Loading Object: Arena");
 
-    auto* arena = ColladaLoader::open(*m_world, assets, "/models/arena.dae",
-        [&](Object::GameObject& object, Engine::MeshBuilder& builder, ColladaLoader::ModelMetaData const& meta_data) {
-            object.add_component<MeshRender>(builder.build(), m_renderer, meta_data.material);
-
-            auto& transform = object.add_component<Transform>();
-            transform.set_position(meta_data.translation);
-            transform.set_scale(meta_data.scale);
-            transform.set_rotation(meta_data.rotation);
+    // None of the arena moves, so its nodes are baked straight into a mesh
+    // per material in each cell, without making objects for them
+    StaticBatcher batcher;
+    auto has_loaded = ColladaLoader::for_each_node(assets, "/models/arena.dae",
+        [&](ColladaLoader::MeshLevels& levels, ColladaLoader::ModelMetaData const& meta_data) {
+            auto transform = Transform::local_transform_for(meta_data.translation, meta_data.scale, meta_data.rotation);
+            batcher.add(levels.front(), transform, meta_data.material);
         });
 
-    if (!arena) {
+    if (!has_loaded) {
         return nullptr;
     }
 
+    auto* arena = &m_world->add_child();
     arena->add_component<Transform>();
+    for (auto const& batch : batcher.batches()) {
+        auto& part = arena->add_child();
+        part.add_component<Transform>();
+        part.add_component<MeshRender>(batch.builder.build(), m_renderer, batch.material);
+    }
     arena->add_component<PhysicsBody2D>(vec2(1), 0.5, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
 
     auto add_collider = [&](vec2 position, vec2 scale, float rotation = 0) {
@@ -262,26 +298,20 @@ void BumperCarsScene::make_sky_box(std::shared_ptr<Texture> sky_box_texture)
 
 static void set_bumper_car_color(GameObject& car, vec3 color)
 {
-    car.for_each([&color](GameObject& object) {
-        auto* attributes = object.first<Attributes>();
-        if (!attributes) {
-            return IteratorDecision::Continue;
-        }
-        if (!attributes->has("Cart")) {
-            return IteratorDecision::Continue;
-        }
-
-        auto* mesh_render = object.first<MeshRender>();
+    static Tag const cart = Tags::intern("Cart");
+
+    assert(car.world());
+    for (auto* object : car.world()->tagged(cart, car)) {
+        auto* mesh_render = object->first<MeshRender>();
         assert(mesh_render);
 
         mesh_render->material().color = color;
-        return IteratorDecision::Break;
-    });
+    }
 }
 
-void BumperCarsScene::make_ai(GameObject& car_template, vec3 position, vec3 color)
+void BumperCarsScene::make_ai(Prefab const& car_prefab, vec3 position, vec3 color)
 {
-    auto& ai = car_template.clone(*m_world);
+    auto& ai = car_prefab.instantiate(*m_world);
     ai.add_component<AI>();
     ai.first<Transform>()->translate(position);
     set_bumper_car_color(ai, color);
@@ -290,6 +320,12 @@ void BumperCarsScene::make_ai(GameObject& car_template, vec3 position, vec3 colo
 bool BumperCarsScene::init()
 {
     auto assets = EmbeddedAssetRepository::construct();
+    TextureUploader::init();
+
+#ifdef WEBASSEMBLY
+    // Browsers on phones get far less memory to play with
+    TextureStreamer::set_budget(32 * 1024 * 1024);
+#endif
 
     update_loading_status("Compiling shaders");
 #ifdef WEBASSEMBLY
@@ -308,13 +344,41 @@ bool BumperCarsScene::init()
     auto skybox_texture = CubeMapTexture::construct(assets, "/textures/skybox/skybox");
 
     m_world = std::make_unique<World>();
+
+    // Input and AI drive the engines, which push the bodies, which the
+    // cameras then follow. Every car only touches its own parts, so the
+    // per car systems can be split across threads.
+    //
+    // Only the AI, with one instance per car, runs at a lower rate. Cameras
+    // are seen every frame, so would judder, and the bounds have to catch
+    // the free camera every frame, or it would clip through walls.
+    m_world->add_system<PlayerController>(Writes<CarEngine> {});
+    m_world->add_system<AI>(Reads<Transform> {}, Writes<CarEngine> {}, Chunked {}, UpdateEvery { 4 });
+    m_world->add_system<CarEngine>(Writes<PhysicsBody2D, Transform> {}, Chunked {});
+    m_world->add_system<PhysicsBody2D>(Writes<Transform> {}, Chunked {});
+    m_world->add_system<InCarCamera>(Reads<PhysicsBody2D> {}, Writes<Transform> {});
+    m_world->add_system<LookAtCamera>(Writes<Transform> {});
+    m_world->add_system<FreeCamera>(Writes<Transform> {});
+    m_world->add_system<BoxBounds3D>(Writes<Transform> {}, Chunked {});
     m_collision_resolver = std::make_unique<CollisionResolver2D>();
 
+    // Everything the simulation changes from tick to tick. Wheel rotations
+    // and the like are worked out from these again on the next update.
+    m_history = std::make_unique<History>(s_history_ticks);
+    m_history->track<Transform>();
+    m_history->track<PhysicsBody2D>();
+    m_history->track<CarEngine>();
+    m_history->track<AI>();
+    m_world->add_listener(*m_history);
+
     m_renderer = std::make_shared<StandardRenderer>(shader, skybox_texture);
     m_sky_box_renderer = std::make_shared<SkyBoxRenderer>(skybox_shader);
     m_view = RenderTexture::construct({ m_sky_box_renderer, m_renderer });
     m_view->add_color_texture();
 
+    m_world->add_listener(*m_renderer);
+    m_world->add_listener(*m_sky_box_renderer);
+
     m_bloom_renderer = std::make_shared<BloomRenderer>(
         bloom_shader, blur_shader,
         m_view->color_texture(0), m_view->color_texture(1));
@@ -341,8 +405,9 @@ bool BumperCarsScene::init()
         vec3(0.2, 1.0, 1.0),
     };
 
+    m_bumper_car_prefab = Prefab::construct(*bumper_car_template);
     for (int i = 0; i < 4; i++) {
-        make_ai(*bumper_car_template, vec3((i - 2) * 5, 0, 10), colors[i]);
+        make_ai(*m_bumper_car_prefab, vec3((i - 2) * 5, 0, 10), colors[i]);
     }
 
     auto* player = bumper_car_template;
@@ -366,8 +431,6 @@ bool BumperCarsScene::init()
 
     FINAL_SECTION_START
     update_loading_status("Initializing World");
-    m_renderer->on_world_updated(*m_world);
-    m_sky_box_renderer->on_world_updated(*m_world);
     m_world->init();
 
     m_finished_loading = true;
@@ -381,15 +444,26 @@ bool BumperCarsScene::init()
 
 void BumperCarsScene::on_render(float delta)
 {
+    // Textures start uploading while the rest is still loading
+    TextureUploader::update();
     if (!m_finished_loading) {
         return;
     }
 
-    m_world->step_physics(delta);
-    m_world->update(delta);
-    m_collision_resolver->resolve(*m_world);
+    // Holding R plays the simulation backwards, one tick per frame
+    auto is_rewinding = Input::is_key_down(Input::Key::R) && m_history->rewind(1);
+    if (!is_rewinding) {
+        m_world->step_physics(delta);
+        m_world->update(delta);
+        m_collision_resolver->resolve(*m_world);
+        m_world->flush_destroyed();
+        m_history->capture();
+    }
+
+    m_world->update_transforms();
 
     m_view->render();
+    TextureStreamer::update();
     m_bloom_renderer->pre_render();
     m_bloom_renderer->render();
 
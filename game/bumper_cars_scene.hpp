@@ -29,11 +29,13 @@ private:
     Object::GameObject* make_cameras(Object::GameObject& player);
     Object::GameObject* make_bumper_car(Engine::AssetRepository const&);
     Object::GameObject* make_arena(Engine::AssetRepository const&);
-    void make_ai(Object::GameObject& car_template, glm::vec3 position, glm::vec3 color);
+    void make_ai(Object::Prefab const& car_prefab, glm::vec3 position, glm::vec3 color);
     void make_sky_box(std::shared_ptr<Engine::Texture> sky_box_texture);
 
     std::unique_ptr<Object::World> m_world { nullptr };
     std::unique_ptr<Engine::CollisionResolver2D> m_collision_resolver { nullptr };
+    std::unique_ptr<Object::Prefab> m_bumper_car_prefab { nullptr };
+    std::unique_ptr<Object::History> m_history { nullptr };
 
     std::shared_ptr<Engine::StandardRenderer> m_renderer { nullptr };
     std::shared_ptr<Engine::SkyBoxRenderer> m_sky_box_renderer { nullptr };
@@ -11,6 +11,7 @@
 #include "gameobject/physics/collider_2d.hpp"
 #include "gameobject/physics/physics_body_2d.hpp"
 #include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
 #include <glm/glm.hpp>
 using namespace Engine;
 using namespace Object;
@@ -25,25 +26,21 @@ void CarEngine::init(Object::GameObject& game_object)
     m_transform = game_object.first<Transform>();
     m_collider = game_object.first<Collider2D>();
 
-    game_object.for_each([this](GameObject& object) {
-        auto* attributes = object.first<Attributes>();
-        if (!attributes) {
-            return IteratorDecision::Continue;
-        }
+    static Tag const wheel = Tags::intern("Wheel");
+    static Tag const wheel_support = Tags::intern("WheelSupport");
 
-        if (attributes->has("Wheel")) {
-            m_wheel_transform = object.first<Transform>();
-        }
-        if (attributes->has("WheelSupport")) {
-            m_wheel_support_transform = object.first<Transform>();
-        }
+    auto* world = game_object.world();
+    assert(world);
 
-        if (m_wheel_transform && m_wheel_support_transform) {
-            return IteratorDecision::Break;
-        }
+    auto wheels = world->tagged(wheel, game_object);
+    if (!wheels.empty()) {
+        m_wheel_transform = wheels.front()->first<Transform>();
+    }
 
-        return IteratorDecision::Continue;
-    });
+    auto wheel_supports = world->tagged(wheel_support, game_object);
+    if (!wheel_supports.empty()) {
+        m_wheel_support_transform = wheel_supports.front()->first<Transform>();
+    }
 
     m_action_enabled.fill(false);
 }
@@ -30,6 +30,18 @@ public:
 
     inline void set_action(Action action, bool value) { m_action_enabled[(size_t)action] = value; }
 
+    struct State {
+        float wheel_direction;
+        std::array<bool, (size_t)Action::Count> action_enabled;
+    };
+
+    [[nodiscard]] inline State state() const { return { m_wheel_direction, m_action_enabled }; }
+    inline void restore(State const& state)
+    {
+        m_wheel_direction = state.wheel_direction;
+        m_action_enabled = state.action_enabled;
+    }
+
 private:
     CarEngine(CarEngine const&) = default;
     CarEngine() = default;
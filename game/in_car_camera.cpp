@@ -8,20 +8,29 @@
 #include "gameobject/gameobject.hpp"
 #include "gameobject/physics/physics_body_2d.hpp"
 #include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
 #include <cassert>
 using namespace Object;
 using namespace Game;
 
 void InCarCamera::init(GameObject& game_object)
 {
+    auto* player = game_object.world()->resolve(m_player);
+    assert(player);
+
     m_transform = game_object.first<Transform>();
-    m_player_transform = m_player->first<Transform>();
-    m_player_body = m_player->first<PhysicsBody2D>();
+    m_player_transform = player->first<Transform>();
+    m_player_body = player->first<PhysicsBody2D>();
     assert(m_transform);
 }
 
-void InCarCamera::update(GameObject&, float delta)
+void InCarCamera::update(GameObject& game_object, float delta)
 {
+    // The player's components go with it
+    if (!game_object.world()->resolve(m_player)) {
+        return;
+    }
+
     assert(m_transform);
     assert(m_player_transform);
     assert(m_player_body);
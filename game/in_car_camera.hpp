@@ -23,12 +23,12 @@ public:
 private:
     InCarCamera(InCarCamera const&) = default;
 
-    explicit InCarCamera(Object::GameObject* player)
+    explicit InCarCamera(Object::Handle player)
         : m_player(player)
     {
     }
 
-    Object::GameObject* m_player { nullptr };
+    Object::Handle m_player;
     Object::Transform* m_transform { nullptr };
     Object::Transform* m_player_transform { nullptr };
     Object::PhysicsBody2D* m_player_body { nullptr };
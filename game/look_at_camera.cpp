@@ -7,6 +7,7 @@
 #include "look_at_camera.hpp"
 #include "gameobject/gameobject.hpp"
 #include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
 #include "glm/geometric.hpp"
 #include "glm/gtx/vector_angle.hpp"
 #include <cassert>
@@ -15,12 +16,20 @@ using namespace Game;
 
 void LookAtCamera::init(GameObject& game_object)
 {
+    auto* player = game_object.world()->resolve(m_player);
+    assert(player);
+
     m_transform = game_object.first<Transform>();
-    m_player_transform = m_player->first<Transform>();
+    m_player_transform = player->first<Transform>();
 }
 
-void LookAtCamera::update(GameObject&, float)
+void LookAtCamera::update(GameObject& game_object, float)
 {
+    // The player's components go with it
+    if (!game_object.world()->resolve(m_player)) {
+        return;
+    }
+
     assert(m_transform);
     assert(m_player_transform);
 
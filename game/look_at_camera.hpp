@@ -23,12 +23,12 @@ public:
 private:
     LookAtCamera(LookAtCamera const&) = default;
 
-    explicit LookAtCamera(Object::GameObject* player)
+    explicit LookAtCamera(Object::Handle player)
         : m_player(player)
     {
     }
 
-    Object::GameObject* m_player { nullptr };
+    Object::Handle m_player;
     Object::Transform* m_transform { nullptr };
     Object::Transform* m_player_transform { nullptr };
 };
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "archetype.hpp"
+#include <algorithm>
+#include <cassert>
+#include <utility>
+using namespace Object;
+
+Archetype::Archetype(Signature signature, std::vector<size_t> data_sizes)
+    : m_signature(std::move(signature))
+    , m_columns(m_signature.size())
+{
+    assert(std::is_sorted(m_signature.begin(), m_signature.end()));
+    assert(data_sizes.size() == m_columns.size());
+
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        m_columns[i].data_size = data_sizes[i];
+    }
+}
+
+// Any components left hold on to their data
+Archetype::~Archetype()
+{
+    for (auto& column : m_columns) {
+        if (column.data_size == 0) {
+            continue;
+        }
+
+        for (auto* component : column.components) {
+            component->move_archetype_data(nullptr);
+        }
+    }
+}
+
+void* Archetype::data(int index, size_t row) const
+{
+    auto const& column = m_columns[index];
+    return column.chunks[row / rows_per_chunk].get() + (row % rows_per_chunk) * column.data_size;
+}
+
+int Archetype::column_index(ComponentTypeId type_index) const
+{
+    auto it = std::lower_bound(m_signature.begin(), m_signature.end(), type_index);
+    if (it == m_signature.end() || *it != type_index) {
+        return -1;
+    }
+
+    return static_cast<int>(it - m_signature.begin());
+}
+
+bool Archetype::contains(Signature const& types) const
+{
+    return std::includes(m_signature.begin(), m_signature.end(), types.begin(), types.end());
+}
+
+size_t Archetype::add(GameObject& object, std::vector<Component*> const& components)
+{
+    assert(components.size() == m_columns.size());
+
+    auto row = m_objects.size();
+    m_objects.push_back(&object);
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        auto& column = m_columns[i];
+        column.components.push_back(components[i]);
+        if (column.data_size == 0) {
+            continue;
+        }
+
+        assert(components[i]->archetype_data_size() == column.data_size);
+        if (row / rows_per_chunk == column.chunks.size()) {
+            column.chunks.push_back(std::make_unique<std::byte[]>(rows_per_chunk * column.data_size));
+        }
+
+        components[i]->move_archetype_data(data(static_cast<int>(i), row));
+    }
+
+    return row;
+}
+
+GameObject* Archetype::remove(size_t row)
+{
+    assert(row < m_objects.size());
+
+    auto last = m_objects.size() - 1;
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        auto& column = m_columns[i];
+        if (column.data_size > 0) {
+            column.components[row]->move_archetype_data(nullptr);
+            if (row != last) {
+                column.components[last]->move_archetype_data(data(static_cast<int>(i), row));
+            }
+
+            // One spare chunk is kept, so a row coming and going at the
+            // edge of a chunk doesn't allocate every time
+            auto chunks_used = (last + rows_per_chunk - 1) / rows_per_chunk;
+            if (column.chunks.size() > chunks_used + 1) {
+                column.chunks.pop_back();
+            }
+        }
+
+        column.components[row] = column.components[last];
+        column.components.pop_back();
+    }
+
+    m_objects[row] = m_objects[last];
+    m_objects.pop_back();
+
+    if (row == last) {
+        return nullptr;
+    }
+
+    return m_objects[row];
+}
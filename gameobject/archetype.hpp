@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "component.hpp"
+#include "forward.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Object {
+
+// Every object with exactly the same set of archetype stored component
+// types. Each component type gets its own column of pointers, so a query
+// skips objects without the types it wants. The components themselves
+// stay owned by their objects, which hand out raw pointers to them, so
+// they're still allocated one at a time from their type's pool.
+//
+// Components with an ArchetypeData keep it in their column's chunks
+// instead, fixed blocks of rows which never move as the table grows, so
+// it can be read linearly, see World::Query::for_each_data. A row's data
+// only moves when another row is swapped into its place, and its
+// component is pointed at the new place.
+class Archetype {
+public:
+    using Signature = std::vector<ComponentTypeId>;
+
+    static constexpr size_t rows_per_chunk = 256;
+
+    // The size of each type's ArchetypeData, zero for those without
+    Archetype(Signature signature, std::vector<size_t> data_sizes);
+    ~Archetype();
+
+    Archetype(Archetype const&) = delete;
+    Archetype& operator=(Archetype const&) = delete;
+
+    [[nodiscard]] inline Signature const& signature() const { return m_signature; }
+    [[nodiscard]] inline size_t size() const { return m_objects.size(); }
+    [[nodiscard]] inline GameObject& object(size_t row) const { return *m_objects[row]; }
+    [[nodiscard]] inline Component* const* column(int index) const { return m_columns[index].components.data(); }
+
+    [[nodiscard]] inline size_t chunk_count() const { return (size() + rows_per_chunk - 1) / rows_per_chunk; }
+    [[nodiscard]] inline size_t rows_in_chunk(size_t chunk) const { return std::min(size() - chunk * rows_per_chunk, rows_per_chunk); }
+    [[nodiscard]] inline void* chunk(int index, size_t chunk) const { return m_columns[index].chunks[chunk].get(); }
+
+    [[nodiscard]] int column_index(ComponentTypeId) const;
+    [[nodiscard]] bool contains(Signature const&) const;
+
+    size_t add(GameObject&, std::vector<Component*> const& components);
+
+    // Swap removes the row, returning the object that was moved into its
+    // place, if any.
+    GameObject* remove(size_t row);
+
+private:
+    void* data(int index, size_t row) const;
+
+    struct Column {
+        std::vector<Component*> components;
+        size_t data_size;
+        std::vector<std::unique_ptr<std::byte[]>> chunks;
+    };
+
+    Signature m_signature;
+    std::vector<GameObject*> m_objects;
+    std::vector<Column> m_columns;
+};
+
+}
@@ -7,7 +7,7 @@
 #pragma once
 
 #include "component.hpp"
-#include <set>
+#include "tag.hpp"
 #include <string>
 
 namespace Object {
@@ -16,18 +16,32 @@ class Attributes : public ComponentBase<Attributes> {
     friend ComponentBase<Attributes>;
 
 public:
-    [[nodiscard]] inline bool has(std::string const& attr) const { return m_attributes.contains(attr); }
+    [[nodiscard]] inline bool has(Tag tag) const { return tag != UNTAGGED && m_tags.test(tag); }
+    [[nodiscard]] inline TagSet const& tags() const { return m_tags; }
+
+    [[nodiscard]] inline bool has(std::string const& attr) const
+    {
+        auto tag = Tags::find(attr);
+        return tag && has(*tag);
+    }
 
 private:
     template<typename... Args>
-    explicit Attributes(Args... args)
-        : m_attributes { args... }
+    explicit Attributes(Args const&... args)
+    {
+        (add(Tags::intern(args)), ...);
+    }
+
+    inline void add(Tag tag)
     {
+        if (tag != UNTAGGED) {
+            m_tags.set(tag);
+        }
     }
 
     Attributes(Attributes const&) = default;
 
-    std::set<std::string> m_attributes;
+    TagSet m_tags;
 };
 
 }
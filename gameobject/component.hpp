@@ -7,13 +7,71 @@
 #pragma once
 
 #include "forward.hpp"
+#include "slab_pool.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <typeinfo>
 
 namespace Object {
 
+using ComponentTypeId = uint32_t;
+
+namespace Detail {
+
+inline std::atomic<ComponentTypeId> s_next_component_type_id { 0 };
+
+}
+
+// A component's hot state, kept in its archetype's table while it has a
+// row in one, so queries can read it linearly, otherwise kept here. The
+// component holds it as m_state and names its type ArchetypeData.
+template<typename Data>
+class ArchetypeStored {
+    static_assert(std::is_trivially_copyable_v<Data>);
+    static_assert(alignof(Data) <= alignof(std::max_align_t));
+
+public:
+    explicit ArchetypeStored(Data const& data)
+        : m_own(data)
+    {
+    }
+
+    // Copies start out of any table
+    ArchetypeStored(ArchetypeStored const& other)
+        : m_own(*other.m_data)
+    {
+    }
+
+    ArchetypeStored& operator=(ArchetypeStored const&) = delete;
+
+    inline Data* operator->() { return m_data; }
+    inline Data const* operator->() const { return m_data; }
+    inline Data& operator*() { return *m_data; }
+    inline Data const& operator*() const { return *m_data; }
+
+    // Copies the state into the storage and uses it from then on, or back
+    // into here if null
+    void move_to(void* storage)
+    {
+        auto* to = storage ? static_cast<Data*>(storage) : &m_own;
+        if (to != m_data) {
+            m_data = new (to) Data(*m_data);
+        }
+    }
+
+private:
+    Data m_own;
+    Data* m_data { &m_own };
+};
+
 class Component {
     friend GameObject;
+    friend World;
+    friend Archetype;
 
 public:
     virtual ~Component() = default;
@@ -25,24 +83,86 @@ public:
     }
 
     [[nodiscard]] virtual char const* type_id() const = 0;
+    [[nodiscard]] virtual ComponentTypeId type_index() const = 0;
+    [[nodiscard]] virtual bool is_stored_in_archetype() const = 0;
     virtual void init(GameObject&) { }
     virtual void update(GameObject&, float delta) { }
     virtual void step_physics(GameObject&, float by) { }
 
 private:
     virtual std::unique_ptr<Component> clone() = 0;
+
+    // Zero for components without an ArchetypeData
+    [[nodiscard]] virtual size_t archetype_data_size() const = 0;
+    virtual void move_archetype_data(void* storage) = 0;
+
+    // Updated by a world system rather than through its game object
+    bool m_is_scheduled { false };
+    size_t m_system_index { 0 };
 };
 
+template<typename T>
+concept has_archetype_data = requires { typename T::ArchetypeData; };
+
 template<typename T>
 class ComponentBase : public Component {
     friend GameObject;
 
 public:
+    // Components opt in to the world's archetype tables by redeclaring
+    // this as true, see World::query. Their hot state can then be kept in
+    // the tables too, see ArchetypeStored.
+    static constexpr bool stored_in_archetype = false;
+
     [[nodiscard]] char const* type_id() const final
     {
         return typeid(T).name();
     }
 
+    [[nodiscard]] ComponentTypeId type_index() const final
+    {
+        return static_type_index();
+    }
+
+    [[nodiscard]] bool is_stored_in_archetype() const final
+    {
+        return T::stored_in_archetype;
+    }
+
+    static ComponentTypeId static_type_index()
+    {
+        static ComponentTypeId const type_index = Detail::s_next_component_type_id++;
+        return type_index;
+    }
+
+    // Every component of a type shares one pool. Anything derived from T
+    // has a different size, so goes to the global heap instead.
+    static void* operator new(size_t size)
+    {
+        if (size != sizeof(T)) {
+            return ::operator new(size);
+        }
+
+        return pool().allocate();
+    }
+
+    static void operator delete(void* pointer, size_t size)
+    {
+        if (size != sizeof(T)) {
+            ::operator delete(pointer);
+            return;
+        }
+
+        pool().deallocate(pointer);
+    }
+
+    static SlabPool& pool()
+    {
+        // Never destroyed, components may outlive static destruction
+        static auto* pool = new SlabPool(typeid(T).name(), sizeof(T), alignof(T));
+        return *pool;
+    }
+
 private:
     template<typename... Args>
     static std::unique_ptr<T> construct(Args&&... args)
@@ -54,6 +174,22 @@ private:
     {
         return std::unique_ptr<T>(new T(static_cast<T const&>(*this)));
     }
+
+    [[nodiscard]] size_t archetype_data_size() const final
+    {
+        if constexpr (has_archetype_data<T>) {
+            return sizeof(typename T::ArchetypeData);
+        } else {
+            return 0;
+        }
+    }
+
+    void move_archetype_data(void* storage) final
+    {
+        if constexpr (has_archetype_data<T>) {
+            static_cast<T&>(*this).m_state.move_to(storage);
+        }
+    }
 };
 
 }
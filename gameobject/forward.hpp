@@ -14,6 +14,11 @@ class Transform;
 class MeshRender;
 class Camera;
 class World;
+class Archetype;
+class TransformHierarchy;
+class Prefab;
+class WorldListener;
+class History;
 class Scene;
 class Light;
 class Collider2D;
@@ -5,12 +5,45 @@
  */
 
 #include "gameobject.hpp"
+#include "world.hpp"
+#include <cassert>
 using namespace Object;
 
+static SlabPool& game_object_pool()
+{
+    // Never destroyed, objects may outlive static destruction
+    static auto* pool = new SlabPool("GameObject", sizeof(GameObject), alignof(GameObject));
+    return *pool;
+}
+
+void* GameObject::operator new(size_t size)
+{
+    // Derived objects, such as the world, are a different size
+    if (size != sizeof(GameObject)) {
+        return ::operator new(size);
+    }
+
+    return game_object_pool().allocate();
+}
+
+void GameObject::operator delete(void* pointer, size_t size)
+{
+    if (size != sizeof(GameObject)) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    game_object_pool().deallocate(pointer);
+}
+
 GameObject& GameObject::add_child()
 {
     auto child = std::unique_ptr<GameObject>(new GameObject);
     child->m_parent = this;
+    child->m_world = m_world;
+    if (m_world) {
+        child->m_handle = m_world->register_object(*child);
+    }
 
     m_children.push_back(std::move(child));
     return *m_children.back();
@@ -19,15 +52,23 @@ GameObject& GameObject::add_child()
 GameObject& GameObject::clone(GameObject& parent)
 {
     auto object = std::unique_ptr<GameObject>(new GameObject);
+    object->m_parent = &parent;
+    object->m_world = parent.m_world;
     for (auto const& component : m_components) {
-        object->m_components.push_back(std::move(component->clone()));
+        auto component_clone = component->clone();
+        component_clone->m_is_scheduled = false;
+        object->m_components.push_back(std::move(component_clone));
+    }
+
+    if (object->m_world) {
+        object->m_handle = object->m_world->register_object(*object);
+        object->m_world->on_object_added(*object);
     }
 
     for (auto const& child : m_children) {
         child->clone(*object);
     }
 
-    object->m_parent = &parent;
     parent.m_children.push_back(std::move(object));
     return *parent.m_children.back();
 }
@@ -39,7 +80,9 @@ void GameObject::update(float delta)
     }
 
     for (auto& component : m_components) {
-        component->update(*this, delta);
+        if (!component->m_is_scheduled) {
+            component->update(*this, delta);
+        }
     }
 
     for (auto& child : m_children) {
@@ -54,7 +97,9 @@ void GameObject::step_physics(float by)
     }
 
     for (auto& component : m_components) {
-        component->step_physics(*this, by);
+        if (!component->m_is_scheduled) {
+            component->step_physics(*this, by);
+        }
     }
 
     for (auto& child : m_children) {
@@ -72,3 +117,86 @@ void GameObject::init()
         child->init();
     }
 }
+
+void GameObject::remove_component(Component& component)
+{
+    auto it = std::find_if(m_components.begin(), m_components.end(), [&](auto const& other) {
+        return other.get() == &component;
+    });
+
+    if (it == m_components.end()) {
+        return;
+    }
+
+    if (m_world) {
+        m_world->on_component_removed(*this, component);
+    }
+
+    m_components.erase(it);
+    if (m_world) {
+        m_world->update_archetype(*this);
+    }
+}
+
+void GameObject::destroy()
+{
+    assert(m_world && m_parent);
+    if (m_is_destroyed) {
+        return;
+    }
+
+    m_is_destroyed = true;
+    m_world->on_object_destroyed(*this);
+}
+
+void GameObject::set_enabled(bool value)
+{
+    if (m_enabled == value) {
+        return;
+    }
+
+    m_enabled = value;
+    if (m_world) {
+        m_world->on_enabled_changed(*this);
+    }
+}
+
+bool GameObject::is_active() const
+{
+    for (auto const* object = this; object; object = object->m_parent) {
+        if (!object->m_enabled) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool GameObject::is_descendant_of(GameObject const& ancestor) const
+{
+    for (auto const* object = m_parent; object; object = object->m_parent) {
+        if (object == &ancestor) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void GameObject::on_component_added(Component& component)
+{
+    if (m_world) {
+        m_world->on_component_added(*this, component);
+    }
+}
+
+Component* GameObject::first_of_type(ComponentTypeId type_index) const
+{
+    for (auto const& component : m_components) {
+        if (component->type_index() == type_index) {
+            return component.get();
+        }
+    }
+
+    return nullptr;
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "component.hpp"
+#include "handle.hpp"
 #include <algorithm>
 #include <memory>
 #include <vector>
@@ -19,22 +20,45 @@ enum class IteratorDecision {
 };
 
 class GameObject {
+    friend World;
+    friend Prefab;
+
 public:
     GameObject& add_child();
     GameObject& clone(GameObject& parent);
 
     virtual ~GameObject() = default;
 
+    // Plain game objects share a pool, see SlabPool
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer, size_t size);
+
     template<typename T, typename... Args>
     T& add_component(Args&&... args)
     {
         m_components.push_back(std::move(T::construct(args...)));
-        return static_cast<T&>(*m_components.back());
+
+        auto& component = static_cast<T&>(*m_components.back());
+        on_component_added(component);
+        return component;
     }
 
+    void remove_component(Component&);
+
     [[nodiscard]] inline GameObject const* parent() const { return m_parent; }
+    [[nodiscard]] inline World* world() const { return m_world; }
+    [[nodiscard]] inline Handle handle() const { return m_handle; }
     [[nodiscard]] inline bool enabled() const { return m_enabled; }
-    inline void set_enabled(bool value) { m_enabled = value; }
+    void set_enabled(bool value);
+
+    // Enabled, and so is every parent
+    [[nodiscard]] bool is_active() const;
+    [[nodiscard]] bool is_descendant_of(GameObject const&) const;
+
+    // Removes the object, and everything below it, from its world at the
+    // end of the tick. Until then it carries on as normal.
+    void destroy();
+    [[nodiscard]] inline bool is_destroyed() const { return m_is_destroyed; }
 
     void update(float delta);
     void step_physics(float by);
@@ -121,11 +145,20 @@ protected:
     GameObject() = default;
 
 private:
-    GameObject const* m_parent { nullptr };
+    void on_component_added(Component&);
+    [[nodiscard]] Component* first_of_type(ComponentTypeId) const;
+
+    GameObject* m_parent { nullptr };
+    World* m_world { nullptr };
+    Handle m_handle;
     std::vector<std::unique_ptr<GameObject>> m_children;
     std::vector<std::unique_ptr<Component>> m_components;
 
+    Archetype* m_archetype { nullptr };
+    size_t m_archetype_row { 0 };
+
     bool m_enabled { true };
+    bool m_is_destroyed { false };
 };
 
 }
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <compare>
+#include <cstdint>
+
+namespace Object {
+
+// Refers to a game object without keeping a pointer to it. A world reuses
+// a destroyed object's slot, bumping its generation each time, so old
+// handles stop resolving rather than pointing at whatever took its place.
+struct Handle {
+    uint32_t index { 0 };
+
+    // Slots start at generation 1, so a default handle never resolves
+    uint32_t generation { 0 };
+
+    auto operator<=>(Handle const&) const = default;
+};
+
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "history.hpp"
+#include <algorithm>
+using namespace Object;
+
+History::History(size_t capacity)
+    : m_frames(std::max<size_t>(capacity, 1))
+{
+}
+
+void History::capture()
+{
+    m_newest = (m_newest + 1) % m_frames.size();
+    m_size = std::min(m_size + 1, m_frames.size());
+
+    // Frames keep their storage, so this only allocates while filling up
+    auto& frame = m_frames[m_newest];
+    frame.resize(frame_size());
+
+    auto* out = frame.data();
+    for (auto const& track : m_tracks) {
+        track.capture(track.components, out);
+        out += track.components.size() * track.state_size;
+    }
+}
+
+bool History::rewind(size_t ticks)
+{
+    if (ticks >= m_size) {
+        return false;
+    }
+
+    m_newest = (m_newest + m_frames.size() - ticks) % m_frames.size();
+    m_size -= ticks;
+
+    auto const* in = m_frames[m_newest].data();
+    for (auto const& track : m_tracks) {
+        track.restore(track.components, in);
+        in += track.components.size() * track.state_size;
+    }
+
+    return true;
+}
+
+void History::clear()
+{
+    m_size = 0;
+}
+
+void History::on_component_added(GameObject&, Component& component)
+{
+    auto* track = track_for(component.type_index());
+    if (!track) {
+        return;
+    }
+
+    track->components.push_back(&component);
+    clear();
+}
+
+void History::on_component_removed(GameObject&, Component& component)
+{
+    auto* track = track_for(component.type_index());
+    if (!track) {
+        return;
+    }
+
+    std::erase(track->components, &component);
+    clear();
+}
+
+History::Track* History::track_for(ComponentTypeId type_index)
+{
+    for (auto& track : m_tracks) {
+        if (track.type_index == type_index) {
+            return &track;
+        }
+    }
+
+    return nullptr;
+}
+
+size_t History::frame_size() const
+{
+    size_t size = 0;
+    for (auto const& track : m_tracks) {
+        size += track.components.size() * track.state_size;
+    }
+
+    return size;
+}
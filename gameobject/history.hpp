@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "component.hpp"
+#include "forward.hpp"
+#include "world_listener.hpp"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Object {
+
+// A ring buffer of the last few ticks of simulation state, for rewinding
+// the world without rebuilding any objects. Tracked component types
+// expose a trivially copyable State, and each tick stores the state of
+// every tracked component packed into one flat frame.
+//
+// Frames are only comparable while the same components exist, so adding
+// or removing a tracked component forgets everything captured so far.
+class History final : public WorldListener {
+public:
+    explicit History(size_t capacity);
+
+    // Must be called before the history is added to a world
+    template<typename T>
+    void track()
+    {
+        static_assert(std::is_trivially_copyable_v<typename T::State>, "Component state must be trivially copyable");
+
+        m_tracks.push_back(Track {
+            .type_index = T::static_type_index(),
+            .state_size = sizeof(typename T::State),
+            .capture = [](std::vector<Component*> const& components, std::byte* out) {
+                for (auto* component : components) {
+                    auto state = static_cast<T const*>(component)->state();
+                    std::memcpy(out, &state, sizeof(state));
+                    out += sizeof(state);
+                }
+            },
+            .restore = [](std::vector<Component*> const& components, std::byte const* in) {
+                for (auto* component : components) {
+                    typename T::State state;
+                    std::memcpy(&state, in, sizeof(state));
+                    static_cast<T*>(component)->restore(state);
+                    in += sizeof(state);
+                }
+            },
+        });
+    }
+
+    // Records the current state as the newest tick
+    void capture();
+
+    // Puts the world back how it was the given number of ticks before the
+    // newest one, dropping everything newer. Returns false if the history
+    // doesn't go back that far.
+    bool rewind(size_t ticks);
+
+    void clear();
+
+    [[nodiscard]] inline size_t size() const { return m_size; }
+    [[nodiscard]] inline size_t capacity() const { return m_frames.size(); }
+
+    void on_component_added(GameObject&, Component&) override;
+    void on_component_removed(GameObject&, Component&) override;
+
+private:
+    struct Track {
+        ComponentTypeId type_index;
+        size_t state_size;
+
+        // One indirect call per type, the loop itself is inlined
+        void (*capture)(std::vector<Component*> const&, std::byte* out);
+        void (*restore)(std::vector<Component*> const&, std::byte const* in);
+
+        std::vector<Component*> components {};
+    };
+
+    Track* track_for(ComponentTypeId);
+    size_t frame_size() const;
+
+    std::vector<Track> m_tracks;
+    std::vector<std::vector<std::byte>> m_frames;
+    size_t m_newest { 0 };
+    size_t m_size { 0 };
+};
+
+}
@@ -9,9 +9,13 @@
 #include "component.hpp"
 #include "engine/forward.hpp"
 #include "engine/graphics/mesh/material.hpp"
+#include "engine/graphics/renderer/renderer.hpp"
+#include <algorithm>
+#include <array>
 #include <glm/glm.hpp>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace Object {
 
@@ -19,24 +23,66 @@ class MeshRender : public ComponentBase<MeshRender> {
     friend ComponentBase<MeshRender>;
 
 public:
-    [[nodiscard]] inline Engine::Mesh const& mesh() const { return *m_mesh; }
+    // Level 0 is full detail, each one after is simpler
+    using Lods = std::vector<std::shared_ptr<Engine::Mesh>>;
+
+    [[nodiscard]] inline Engine::Mesh const& mesh() const { return *m_lods->front(); }
+    [[nodiscard]] inline Engine::Mesh const& mesh(int lod) const { return *(*m_lods)[lod]; }
+    [[nodiscard]] inline int lod_count() const { return static_cast<int>(m_lods->size()); }
     [[nodiscard]] inline Engine::Renderer const& renderer() const { return *m_renderer; }
-    [[nodiscard]] inline Engine::Material const& material() const { return m_material; }
+    [[nodiscard]] inline Engine::Material const& material() const { return *m_material; }
+
+    // Copies share a material until one of them changes it. The renderer
+    // picks up the change before its next frame.
+    inline Engine::Material& material()
+    {
+        if (m_material.use_count() > 1) {
+            m_material = std::make_shared<Engine::Material>(*m_material);
+        }
+
+        m_renderer->mark_materials_dirty();
+        return const_cast<Engine::Material&>(*m_material);
+    }
+
+    // Picks a level for the mesh's size on screen, as a fraction of the
+    // view's height. Levels only change once the size is a little past
+    // the threshold, so an object sat on one doesn't flicker between them.
+    [[nodiscard]] inline int choose_lod(float screen_size, int current) const
+    {
+        auto lod = std::min(current, lod_count() - 1);
+        while (lod < lod_count() - 1 && lod < static_cast<int>(s_lod_screen_sizes.size())
+            && screen_size < s_lod_screen_sizes[lod] * (1.0f - s_lod_hysteresis)) {
+            lod += 1;
+        }
+        while (lod > 0 && screen_size > s_lod_screen_sizes[lod - 1] * (1.0f + s_lod_hysteresis)) {
+            lod -= 1;
+        }
 
-    inline Engine::Material& material() { return m_material; }
+        return lod;
+    }
 
 private:
     MeshRender(MeshRender const&) = default;
     MeshRender(std::shared_ptr<Engine::Mesh> mesh, std::shared_ptr<Engine::Renderer> renderer, Engine::Material material)
-        : m_mesh(std::move(mesh))
+        : MeshRender(Lods { std::move(mesh) }, std::move(renderer), std::move(material))
+    {
+    }
+
+    MeshRender(Lods lods, std::shared_ptr<Engine::Renderer> renderer, Engine::Material material)
+        : m_lods(std::make_shared<Lods const>(std::move(lods)))
         , m_renderer(std::move(renderer))
-        , m_material(std::move(material))
+        , m_material(std::make_shared<Engine::Material>(std::move(material)))
     {
     }
 
-    std::shared_ptr<Engine::Mesh> m_mesh;
+    // Screen size below which each level gives way to the next
+    static constexpr std::array s_lod_screen_sizes = { 0.2f, 0.1f, 0.05f };
+    static constexpr float s_lod_hysteresis = 0.15f;
+
+    // Copies share their levels, a copy only costs a few reference counts
+    std::shared_ptr<Lods const> m_lods;
     std::shared_ptr<Engine::Renderer> m_renderer;
-    Engine::Material m_material;
+    std::shared_ptr<Engine::Material const> m_material;
 };
 
 }
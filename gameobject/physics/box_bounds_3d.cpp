@@ -20,7 +20,7 @@ void BoxBounds3D::update(GameObject&, float by)
     assert(m_transform);
 
     auto position = m_transform->position();
-    for (auto const& box : m_boxes) {
+    for (auto const& box : *m_boxes) {
         auto penetration = -(glm::abs(position - box.position) - box.half_extents);
         if (penetration.x < 0 || penetration.y < 0 || penetration.z < 0) {
             continue;
@@ -8,6 +8,7 @@
 
 #include "gameobject/component.hpp"
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 
 namespace Object {
@@ -28,12 +29,14 @@ private:
     BoxBounds3D(BoxBounds3D const&) = default;
 
     BoxBounds3D(std::vector<Box> boxes)
-        : m_boxes(std::move(boxes))
+        : m_boxes(std::make_shared<std::vector<Box> const>(std::move(boxes)))
     {
     }
 
     Object::Transform* m_transform { nullptr };
-    std::vector<Box> m_boxes;
+
+    // Shared between copies
+    std::shared_ptr<std::vector<Box> const> m_boxes;
 };
 
 }
@@ -8,7 +8,7 @@
 using namespace Engine;
 using namespace Object;
 
-Collider2D::Collider2D(std::shared_ptr<CollisionShape2D> shape)
+Collider2D::Collider2D(std::shared_ptr<CollisionShape2D const> shape)
     : m_shape(std::move(shape))
 {
 }
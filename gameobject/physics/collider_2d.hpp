@@ -8,6 +8,7 @@
 
 #include "engine/forward.hpp"
 #include "gameobject/component.hpp"
+#include "gameobject/handle.hpp"
 #include <set>
 
 namespace Object {
@@ -17,16 +18,20 @@ class Collider2D : public ComponentBase<Collider2D> {
     friend Engine::CollisionResolver2D;
 
 public:
-    inline Engine::CollisionShape2D& shape() { return *m_shape; }
+    static constexpr bool stored_in_archetype = true;
+
+    // Shapes never change, so copies share them
     inline Engine::CollisionShape2D const& shape() const { return *m_shape; }
-    inline std::set<GameObject*> const& objects_in_collision_with() const { return m_objects_in_collision_with; }
+
+    // Resolve through the world, see World::resolve
+    inline std::set<Handle> const& objects_in_collision_with() const { return m_objects_in_collision_with; }
 
 private:
     Collider2D(Collider2D const&) = default;
-    Collider2D(std::shared_ptr<Engine::CollisionShape2D>);
+    Collider2D(std::shared_ptr<Engine::CollisionShape2D const>);
 
-    std::shared_ptr<Engine::CollisionShape2D> m_shape;
-    std::set<GameObject*> m_objects_in_collision_with;
+    std::shared_ptr<Engine::CollisionShape2D const> m_shape;
+    std::set<Handle> m_objects_in_collision_with;
 };
 
 }
@@ -25,17 +25,17 @@ void PhysicsBody2D::step_physics(GameObject&, float by)
 {
     assert(m_transform);
 
-    m_transform->translate(vec_2to3(m_velocity * by));
-    m_transform->rotate(vec3(0, 1, 0), -m_angular_velocity * by);
+    m_transform->translate(vec_2to3(m_state->velocity * by));
+    m_transform->rotate(vec3(0, 1, 0), -m_state->angular_velocity * by);
 
-    auto factor = abs(glm::dot(glm::normalize(m_velocity), glm::normalize(vec_3to2(m_transform->forward()))));
+    auto factor = abs(glm::dot(glm::normalize(m_state->velocity), glm::normalize(vec_3to2(m_transform->forward()))));
     if (!std::isnan(factor) && !std::isinf(factor)) {
         auto friction = factor * m_friction.y + (1.0 - factor) * m_friction.x;
-        m_velocity *= 1.0 - (friction * by);
+        m_state->velocity *= 1.0 - (friction * by);
     }
-    m_angular_velocity *= 1.0 - 0.1;
+    m_state->angular_velocity *= 1.0 - 0.1;
 
-    assert(!std::isnan(m_velocity.x));
+    assert(!std::isnan(m_state->velocity.x));
 }
 
 void PhysicsBody2D::apply_impulse(glm::vec2 impulse, glm::vec2 contact_point)
@@ -51,17 +51,17 @@ void PhysicsBody2D::apply_impulse(glm::vec2 impulse, glm::vec2 contact_point)
 
 float PhysicsBody2D::speed() const
 {
-    return glm::length(m_velocity);
+    return glm::length(m_state->velocity);
 }
 
 float PhysicsBody2D::sideways_speed() const
 {
-    auto a = glm::normalize(m_velocity);
+    auto a = glm::normalize(m_state->velocity);
     auto b = glm::normalize(vec_3to2(m_transform->forward()));
     return speed() * (1.0 - abs(glm::dot(a, b)));
 }
 
 float PhysicsBody2D::velocity_angle() const
 {
-    return glm::orientedAngle(glm::vec2(0, 1), glm::normalize(m_velocity));
+    return glm::orientedAngle(glm::vec2(0, 1), glm::normalize(m_state->velocity));
 }
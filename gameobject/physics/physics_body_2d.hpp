@@ -16,16 +16,18 @@ class PhysicsBody2D : public ComponentBase<PhysicsBody2D> {
     friend ComponentBase<PhysicsBody2D>;
 
 public:
+    static constexpr bool stored_in_archetype = true;
+
     virtual void init(GameObject&) final;
     virtual void step_physics(GameObject&, float by) final;
 
-    inline glm::vec2 const& velocity() const { return m_velocity; }
-    inline float angular_velocity() const { return m_angular_velocity; }
+    inline glm::vec2 const& velocity() const { return m_state->velocity; }
+    inline float angular_velocity() const { return m_state->angular_velocity; }
     inline float restitution() const { return m_restitution; }
     inline float mass() const { return m_mass; }
     inline float inertia() const { return m_inertia; }
-    inline void apply_force(glm::vec2 force) { m_velocity += force; }
-    inline void apply_torque(float torque) { m_angular_velocity += torque; }
+    inline void apply_force(glm::vec2 force) { m_state->velocity += force; }
+    inline void apply_torque(float torque) { m_state->angular_velocity += torque; }
     void apply_impulse(glm::vec2 impulse, glm::vec2 contact_point);
 
     float speed() const;
@@ -34,11 +36,21 @@ public:
 
     inline bool is_static() const { return m_mass == std::numeric_limits<float>::infinity(); }
 
+    struct State {
+        glm::vec2 velocity;
+        float angular_velocity;
+    };
+
+    // Kept in the world's archetype tables, see ArchetypeStored
+    using ArchetypeData = State;
+
+    [[nodiscard]] inline State state() const { return *m_state; }
+    inline void restore(State const& state) { *m_state = state; }
+
 private:
     PhysicsBody2D(PhysicsBody2D const&) = default;
     PhysicsBody2D(glm::vec2 friction, float restitution, float mass, float inertia)
-        : m_velocity()
-        , m_angular_velocity(0)
+        : m_state(State { .velocity = glm::vec2(0), .angular_velocity = 0 })
         , m_friction(friction)
         , m_restitution(restitution)
         , m_mass(mass)
@@ -46,8 +58,7 @@ private:
     {
     }
 
-    glm::vec2 m_velocity;
-    float m_angular_velocity;
+    ArchetypeStored<State> m_state;
 
     glm::vec2 m_friction;
     float m_restitution;
@@ -0,0 +1,28 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "prefab.hpp"
+#include "gameobject.hpp"
+using namespace Object;
+
+Prefab::Prefab()
+    : m_holder(new GameObject)
+{
+}
+
+Prefab::~Prefab() = default;
+
+std::unique_ptr<Prefab> Prefab::construct(GameObject& source)
+{
+    auto prefab = std::unique_ptr<Prefab>(new Prefab);
+    prefab->m_root = &source.clone(*prefab->m_holder);
+    return prefab;
+}
+
+GameObject& Prefab::instantiate(GameObject& parent) const
+{
+    return m_root->clone(parent);
+}
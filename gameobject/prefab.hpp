@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "forward.hpp"
+#include <memory>
+
+namespace Object {
+
+// A detached copy of an object tree to spawn instances from. Instances
+// are cloned from it component by component, but components keep their
+// immutable data (mesh levels, materials, collision shapes and bounds)
+// behind shared pointers. So an instance only allocates its objects and
+// their per instance state, and a material is only copied once an
+// instance changes it.
+class Prefab {
+public:
+    static std::unique_ptr<Prefab> construct(GameObject& source);
+    ~Prefab();
+
+    GameObject& instantiate(GameObject& parent) const;
+
+private:
+    Prefab();
+
+    // Never part of a world, so nothing in here is updated or rendered
+    std::unique_ptr<GameObject> m_holder;
+    GameObject* m_root { nullptr };
+};
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "slab_pool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <new>
+using namespace Object;
+
+static constexpr size_t s_slab_size = 16 * 1024;
+
+static std::vector<SlabPool*>& all_pools()
+{
+    // Never destroyed, as pools may still be in use during static destruction
+    static auto* pools = new std::vector<SlabPool*>;
+    return *pools;
+}
+
+SlabPool::SlabPool(char const* name, size_t object_size, size_t object_alignment)
+    : m_name(name)
+    , m_slot_alignment(std::max(object_alignment, alignof(void*)))
+{
+    // Free slots store the next free slot in place
+    auto size = std::max(object_size, sizeof(void*));
+    m_slot_size = (size + m_slot_alignment - 1) / m_slot_alignment * m_slot_alignment;
+    m_slots_per_slab = std::max(s_slab_size / m_slot_size, size_t(1));
+
+    all_pools().push_back(this);
+}
+
+void SlabPool::add_slab()
+{
+    auto* slab = static_cast<std::byte*>(::operator new(m_slot_size * m_slots_per_slab, std::align_val_t(m_slot_alignment)));
+    m_slabs.push_back(slab);
+    m_stats.slabs += 1;
+
+    // Thread the slots in address order, so a fresh slab is handed out
+    // front to back
+    for (size_t i = m_slots_per_slab; i > 0; i--) {
+        auto* slot = slab + (i - 1) * m_slot_size;
+        *reinterpret_cast<void**>(slot) = m_free_list;
+        m_free_list = slot;
+    }
+}
+
+void* SlabPool::allocate()
+{
+    if (!m_free_list) {
+        add_slab();
+    }
+
+    auto* slot = m_free_list;
+    m_free_list = *static_cast<void**>(slot);
+
+    m_stats.allocations += 1;
+    m_stats.live_objects += 1;
+    m_stats.peak_objects = std::max(m_stats.peak_objects, m_stats.live_objects);
+    return slot;
+}
+
+void SlabPool::deallocate(void* slot)
+{
+    if (!slot) {
+        return;
+    }
+
+    assert(m_stats.live_objects > 0);
+    *static_cast<void**>(slot) = m_free_list;
+    m_free_list = slot;
+
+    m_stats.frees += 1;
+    m_stats.live_objects -= 1;
+}
+
+void SlabPool::for_each(std::function<void(SlabPool const&)> const& callback)
+{
+    for (auto const* pool : all_pools()) {
+        callback(*pool);
+    }
+}
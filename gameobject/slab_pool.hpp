@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace Object {
+
+// Hands out fixed size slots from large slabs, reusing freed slots
+// through a free list. Slabs are never moved or released, so addresses
+// stay stable for as long as the object lives.
+//
+// Objects are only created and destroyed on the main thread, so pools
+// don't lock.
+class SlabPool {
+public:
+    struct Stats {
+        size_t live_objects { 0 };
+        size_t peak_objects { 0 };
+        size_t slabs { 0 };
+        size_t allocations { 0 };
+        size_t frees { 0 };
+    };
+
+    SlabPool(char const* name, size_t object_size, size_t object_alignment);
+    SlabPool(SlabPool const&) = delete;
+    SlabPool& operator=(SlabPool const&) = delete;
+
+    void* allocate();
+    void deallocate(void*);
+
+    [[nodiscard]] inline char const* name() const { return m_name; }
+    [[nodiscard]] inline Stats const& stats() const { return m_stats; }
+
+    static void for_each(std::function<void(SlabPool const&)> const&);
+
+private:
+    void add_slab();
+
+    char const* m_name;
+    size_t m_slot_size;
+    size_t m_slot_alignment;
+    size_t m_slots_per_slab;
+
+    void* m_free_list { nullptr };
+    std::vector<void*> m_slabs;
+    Stats m_stats;
+};
+
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "system.hpp"
+#include <algorithm>
+using namespace Object;
+
+static bool contains_any(std::vector<ComponentTypeId> const& types, std::vector<ComponentTypeId> const& of)
+{
+    return std::any_of(of.begin(), of.end(), [&](auto type) {
+        return std::find(types.begin(), types.end(), type) != types.end();
+    });
+}
+
+void System::declare(UpdateEvery every)
+{
+    m_interval = std::max<size_t>(every.frames, 1);
+    m_slice = 0;
+    m_slice_deltas.assign(m_interval, 0);
+}
+
+float System::begin_update(float delta)
+{
+    m_slice = (m_slice + 1) % m_interval;
+    for (auto& slice_delta : m_slice_deltas) {
+        slice_delta += delta;
+    }
+
+    // Components swap removed into another slice may be given a slightly
+    // different delta once, which doesn't matter at these rates
+    auto slice_delta = m_slice_deltas[m_slice];
+    m_slice_deltas[m_slice] = 0;
+    return slice_delta;
+}
+
+bool System::conflicts_with(System const& other) const
+{
+    return contains_any(other.m_writes, m_writes)
+        || contains_any(other.m_writes, m_reads)
+        || contains_any(m_writes, other.m_reads);
+}
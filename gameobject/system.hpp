@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "component.hpp"
+#include "gameobject.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Object {
+
+// Component types a system reads from or writes to, other than its own
+// type, which it always writes.
+template<typename... Ts>
+struct Reads {
+};
+
+template<typename... Ts>
+struct Writes {
+};
+
+// Each component only touches its own object, so the system's entries
+// can be split across threads.
+struct Chunked {
+};
+
+// Updates a different slice of the components each frame, so each one
+// runs once every so many frames and is given the time since it last
+// ran. Physics steps still run for every component every step.
+struct UpdateEvery {
+    size_t frames;
+};
+
+// Updates every live component of one type in a single loop, so the
+// world only pays one virtual call per type rather than per component.
+class System {
+public:
+    virtual ~System() = default;
+
+    // Returns the component's index in the system
+    virtual size_t add(GameObject&, Component&) = 0;
+
+    // Swap removes the entry, returning the component that was moved into
+    // its place, if any.
+    virtual Component* remove(size_t index) = 0;
+
+    // Kept up to date by the world as objects are enabled and disabled
+    virtual void set_active(size_t index, bool is_active) = 0;
+
+    virtual void update(float delta, size_t begin, size_t end) = 0;
+    virtual void step_physics(float by, size_t begin, size_t end) = 0;
+
+    [[nodiscard]] virtual size_t size() const = 0;
+    [[nodiscard]] virtual bool has_update() const = 0;
+    [[nodiscard]] virtual bool has_step_physics() const = 0;
+
+    template<typename... Ts>
+    void declare(Reads<Ts...>) { (m_reads.push_back(Ts::static_type_index()), ...); }
+
+    template<typename... Ts>
+    void declare(Writes<Ts...>) { (m_writes.push_back(Ts::static_type_index()), ...); }
+
+    void declare(Chunked) { m_is_chunked = true; }
+    void declare(UpdateEvery);
+
+    [[nodiscard]] inline bool is_chunked() const { return m_is_chunked; }
+
+    // Moves on to the next slice, returning the delta to update it with.
+    // Called once a frame before any of the system's updates.
+    float begin_update(float delta);
+
+    // Two systems conflict if either writes a type the other uses
+    [[nodiscard]] bool conflicts_with(System const&) const;
+
+protected:
+    // The first index in the current slice at or after the given one
+    [[nodiscard]] inline size_t first_in_slice(size_t index) const
+    {
+        return index + (m_slice + m_interval - index % m_interval) % m_interval;
+    }
+
+    [[nodiscard]] inline size_t interval() const { return m_interval; }
+
+private:
+    std::vector<ComponentTypeId> m_reads;
+    std::vector<ComponentTypeId> m_writes;
+    bool m_is_chunked { false };
+
+    size_t m_interval { 1 };
+    size_t m_slice { 0 };
+    std::vector<float> m_slice_deltas { 0 };
+};
+
+template<typename T>
+class ComponentSystem final : public System {
+public:
+    ComponentSystem()
+    {
+        declare(Writes<T> {});
+    }
+
+    size_t add(GameObject& game_object, Component& component) override
+    {
+        m_entries.push_back(Entry { static_cast<T*>(&component), &game_object, game_object.is_active() });
+        return m_entries.size() - 1;
+    }
+
+    Component* remove(size_t index) override
+    {
+        auto last = m_entries.size() - 1;
+        m_entries[index] = m_entries[last];
+        m_entries.pop_back();
+        return index == last ? nullptr : m_entries[index].component;
+    }
+
+    void set_active(size_t index, bool is_active) override
+    {
+        m_entries[index].is_active = is_active;
+    }
+
+    void update(float delta, size_t begin, size_t end) override
+    {
+        if constexpr (overrides_update) {
+            for (size_t i = first_in_slice(begin); i < end; i += interval()) {
+                auto const& entry = m_entries[i];
+                if (entry.is_active) {
+                    entry.component->T::update(*entry.game_object, delta);
+                }
+            }
+        }
+    }
+
+    void step_physics(float by, size_t begin, size_t end) override
+    {
+        if constexpr (overrides_step_physics) {
+            for (size_t i = begin; i < end; i++) {
+                auto const& entry = m_entries[i];
+                if (entry.is_active) {
+                    entry.component->T::step_physics(*entry.game_object, by);
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const override { return m_entries.size(); }
+    [[nodiscard]] bool has_update() const override { return overrides_update; }
+    [[nodiscard]] bool has_step_physics() const override { return overrides_step_physics; }
+
+private:
+    // Types which inherit the empty default can skip the loop entirely
+    static constexpr bool overrides_update = !std::is_same_v<decltype(&T::update), decltype(&Component::update)>;
+    static constexpr bool overrides_step_physics = !std::is_same_v<decltype(&T::step_physics), decltype(&Component::step_physics)>;
+
+    struct Entry {
+        T* component;
+        GameObject* game_object;
+
+        // Cached, checking every parent per component would be too slow
+        bool is_active;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "tag.hpp"
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+using namespace Object;
+
+static std::mutex s_tags_mutex;
+static std::unordered_map<std::string, Tag> s_tags_by_name;
+static std::vector<std::string> s_tag_names;
+
+Tag Tags::intern(std::string const& name)
+{
+    std::lock_guard<std::mutex> guard(s_tags_mutex);
+    auto it = s_tags_by_name.find(name);
+    if (it != s_tags_by_name.end()) {
+        return it->second;
+    }
+
+    // Every node name in a model is a tag, so a big scene could run out
+    if (s_tag_names.size() >= MAX_TAGS) {
+        std::cerr << "Warning: Out of tags, '" << name << "' will be untagged\n";
+        return UNTAGGED;
+    }
+
+    auto tag = static_cast<Tag>(s_tag_names.size());
+    s_tag_names.push_back(name);
+    s_tags_by_name.emplace(name, tag);
+    return tag;
+}
+
+std::optional<Tag> Tags::find(std::string const& name)
+{
+    std::lock_guard<std::mutex> guard(s_tags_mutex);
+    auto it = s_tags_by_name.find(name);
+    if (it == s_tags_by_name.end()) {
+        return std::nullopt;
+    }
+
+    return it->second;
+}
+
+std::string const& Tags::name(Tag tag)
+{
+    static std::string const untagged;
+    if (tag == UNTAGGED) {
+        return untagged;
+    }
+
+    std::lock_guard<std::mutex> guard(s_tags_mutex);
+    return s_tag_names[tag];
+}
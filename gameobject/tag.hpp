@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace Object {
+
+// Tags are interned once, so checking and indexing them is just a small
+// integer rather than a string compare.
+using Tag = uint8_t;
+constexpr size_t MAX_TAGS = 64;
+using TagSet = std::bitset<MAX_TAGS>;
+
+// Handed out once every tag is taken, and never set on anything
+constexpr Tag UNTAGGED = MAX_TAGS;
+
+namespace Tags {
+
+Tag intern(std::string const& name);
+std::optional<Tag> find(std::string const& name);
+std::string const& name(Tag);
+
+}
+
+}
@@ -7,38 +7,40 @@
 #include "transform.hpp"
 #include "engine/physics/collision_shape_utils_2d.hpp"
 #include "gameobject.hpp"
+#include "transform_hierarchy.hpp"
 #include <glm/ext/matrix_transform.hpp>
 using namespace Engine;
 using namespace Object;
 
+// Copies aren't part of a hierarchy until the world places them
+Transform::Transform(Transform const& other)
+    : ComponentBase<Transform>(other)
+    , m_state(other.m_state)
+    , m_local_affine_cache(other.m_local_affine_cache)
+    , m_is_local_cache_dirty(other.m_is_local_cache_dirty)
+{
+}
+
 Transform::~Transform() = default;
 
-glm::mat4 Transform::local_transform() const
+Affine const& Transform::local_affine() const
 {
-    if (!m_is_local_cache_dirty) {
-        return m_local_transform_cache;
+    if (m_is_local_cache_dirty) {
+        m_local_affine_cache = Affine::from(m_state->position, m_state->orientation, m_state->scale);
+        m_is_local_cache_dirty = false;
     }
 
-    glm::mat4 transform(1);
-    transform = glm::translate(transform, m_position);
-    transform = glm::rotate(transform, m_rotation.x, glm::vec3(1, 0, 0));
-    transform = glm::rotate(transform, m_rotation.y, glm::vec3(0, 1, 0));
-    transform = glm::rotate(transform, m_rotation.z, glm::vec3(0, 0, 1));
-    transform = glm::scale(transform, m_scale);
-    m_local_transform_cache = transform;
-    m_is_local_cache_dirty = false;
-    return transform;
+    return m_local_affine_cache;
+}
+
+glm::mat4 Transform::local_transform() const
+{
+    return local_affine().to_mat4();
 }
 
 glm::mat4 Transform::local_inverse_transform() const
 {
-    glm::mat4 transform(1);
-    transform = glm::scale(transform, 1.0f / m_scale);
-    transform = glm::rotate(transform, -m_rotation.x, glm::vec3(1, 0, 0));
-    transform = glm::rotate(transform, -m_rotation.y, glm::vec3(0, 1, 0));
-    transform = glm::rotate(transform, -m_rotation.z, glm::vec3(0, 0, 1));
-    transform = glm::translate(transform, -m_position);
-    return transform;
+    return Affine::inverse_of(m_state->position, m_state->inverse_orientation, m_state->scale).to_mat4();
 }
 
 static glm::mat4 local_to_global(glm::mat4 local, GameObject const& game_object)
@@ -57,12 +59,11 @@ static glm::mat4 local_to_global(glm::mat4 local, GameObject const& game_object)
 
 glm::mat4 Transform::global_transform(GameObject const& game_object) const
 {
-    if (m_is_global_cache_dirty || m_is_local_cache_dirty) {
-        m_global_transform_cache = local_to_global(local_transform(), game_object);
-        m_is_global_cache_dirty = false;
+    if (m_hierarchy && !m_hierarchy->is_structure_dirty()) {
+        return m_hierarchy->global(m_hierarchy_index);
     }
 
-    return m_global_transform_cache;
+    return local_to_global(local_transform(), game_object);
 }
 
 glm::mat4 Transform::global_inverse_transform(GameObject const& game_object) const
@@ -73,9 +74,9 @@ glm::mat4 Transform::global_inverse_transform(GameObject const& game_object) con
 Transform::Computed Transform::computed_transform() const
 {
     return Computed {
-        m_position,
-        m_scale,
-        m_rotation,
+        m_state->position,
+        m_state->scale,
+        m_state->rotation,
         local_transform(),
     };
 }
@@ -83,54 +84,57 @@ Transform::Computed Transform::computed_transform() const
 Transform::Computed2D Transform::computed_transform_2d() const
 {
     glm::mat4 transform_2d(1);
-    transform_2d = glm::translate(transform_2d, glm::vec3(vec_3to2(m_position), 0));
-    transform_2d = glm::rotate(transform_2d, -m_rotation.y, glm::vec3(0, 0, 1));
-    transform_2d = glm::scale(transform_2d, glm::vec3(vec_3to2(m_scale), 0));
+    transform_2d = glm::translate(transform_2d, glm::vec3(vec_3to2(m_state->position), 0));
+    transform_2d = glm::rotate(transform_2d, -m_state->rotation.y, glm::vec3(0, 0, 1));
+    transform_2d = glm::scale(transform_2d, glm::vec3(vec_3to2(m_state->scale), 0));
 
     return Computed2D {
-        vec_3to2(m_position),
-        vec_3to2(m_scale),
-        -m_rotation.y,
+        vec_3to2(m_state->position),
+        vec_3to2(m_state->scale),
+        -m_state->rotation.y,
         transform_2d,
     };
 }
 
-glm::vec3 Transform::forward() const
+void Transform::restore(State const& state)
 {
-    auto x = -std::sin(m_rotation.y);
-    auto z = -std::cos(m_rotation.y);
-    return { x, 0, z };
+    *m_state = state;
+    on_change();
 }
 
-glm::vec3 Transform::left() const
+glm::mat4 Transform::local_transform_for(glm::vec3 position, glm::vec3 scale, glm::vec3 rotation)
 {
-    auto x = -std::sin(m_rotation.y + glm::radians(90.0f));
-    auto z = -std::cos(m_rotation.y + glm::radians(90.0f));
-    return { x, 0, z };
+    auto x = glm::angleAxis(rotation.x, glm::vec3(1, 0, 0));
+    auto y = glm::angleAxis(rotation.y, glm::vec3(0, 1, 0));
+    auto z = glm::angleAxis(rotation.z, glm::vec3(0, 0, 1));
+    return Affine::from(position, x * y * z, scale).to_mat4();
 }
 
-void Transform::init(GameObject& game_object)
+void Transform::on_rotation_change()
 {
-    m_game_object = &game_object;
+    auto x = glm::angleAxis(m_state->rotation.x, glm::vec3(1, 0, 0));
+    auto y = glm::angleAxis(m_state->rotation.y, glm::vec3(0, 1, 0));
+    auto z = glm::angleAxis(m_state->rotation.z, glm::vec3(0, 0, 1));
+    m_state->orientation = x * y * z;
+
+    // Cameras expect the inverse to undo x first, so this isn't just the
+    // conjugate of the orientation
+    m_state->inverse_orientation = glm::conjugate(z * y * x);
+
+    auto sin_y = std::sin(m_state->rotation.y);
+    auto cos_y = std::cos(m_state->rotation.y);
+    m_state->forward = glm::vec3(-sin_y, 0, -cos_y);
+    m_state->left = glm::vec3(-cos_y, 0, sin_y);
+
+    on_change();
 }
 
-void Transform::on_change(bool global_change)
+void Transform::on_change()
 {
-    if (!global_change) {
-        m_is_local_cache_dirty = true;
-    }
+    m_is_local_cache_dirty = true;
 
-    if (m_is_global_cache_dirty || !m_game_object) {
-        return;
+    // Children pick up the change in the hierarchy's next update
+    if (m_hierarchy && !m_hierarchy->is_structure_dirty()) {
+        m_hierarchy->mark_dirty(m_hierarchy_index);
     }
-
-    m_is_global_cache_dirty = true;
-    m_game_object->for_each_child([](GameObject& child) {
-        auto* transform = child.first<Transform>();
-        if (transform) {
-            transform->on_change(true);
-        }
-
-        return IteratorDecision::Continue;
-    });
 }
@@ -7,15 +7,20 @@
 #pragma once
 
 #include "component.hpp"
+#include "engine/math/affine.hpp"
 #include "forward.hpp"
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 namespace Object {
 
 class Transform : public ComponentBase<Transform> {
     friend ComponentBase<Transform>;
+    friend TransformHierarchy;
 
 public:
+    static constexpr bool stored_in_archetype = true;
+
     ~Transform() override;
 
     struct Computed {
@@ -32,7 +37,12 @@ public:
         glm::mat4 transform;
     };
 
+    Engine::Affine const& local_affine() const;
     glm::mat4 local_transform() const;
+
+    // The local transform a Transform set to these would have, for placing
+    // things which don't need a Transform of their own
+    static glm::mat4 local_transform_for(glm::vec3 position, glm::vec3 scale, glm::vec3 rotation);
     glm::mat4 local_inverse_transform() const;
     glm::mat4 global_transform(GameObject const& game_object) const;
     glm::mat4 global_inverse_transform(GameObject const& game_object) const;
@@ -42,63 +52,94 @@ public:
 
     inline void set_position(glm::vec3 position)
     {
-        m_position = position;
+        m_state->position = position;
         on_change();
     }
     inline void set_scale(glm::vec3 scale)
     {
-        m_scale = scale;
+        m_state->scale = scale;
         on_change();
     }
     inline void set_rotation(glm::vec3 rotation)
     {
-        m_rotation = rotation;
-        on_change();
+        m_state->rotation = rotation;
+        on_rotation_change();
     }
 
-    inline glm::vec3 const& position() const { return m_position; }
-    inline glm::vec3 const& scale() const { return m_scale; }
-    inline glm::vec3 const& rotation() const { return m_rotation; }
+    inline glm::vec3 const& position() const { return m_state->position; }
+    inline glm::vec3 const& scale() const { return m_state->scale; }
+    inline glm::vec3 const& rotation() const { return m_state->rotation; }
+    inline glm::quat const& orientation() const { return m_state->orientation; }
 
     inline void translate(glm::vec3 offset)
     {
-        m_position += offset;
+        m_state->position += offset;
         on_change();
     }
     inline void scale_by(glm::vec3 amount)
     {
-        m_scale += amount;
+        m_state->scale += amount;
         on_change();
     }
-    inline void rotate(glm::vec3 axis, float amount) { m_rotation += axis * amount; }
+    inline void rotate(glm::vec3 axis, float amount)
+    {
+        m_state->rotation += axis * amount;
+        on_rotation_change();
+    }
+
+    // Along the ground, ignoring any pitch or roll
+    inline glm::vec3 const& forward() const { return m_state->forward; }
+    inline glm::vec3 const& left() const { return m_state->left; }
+
+    // What History records. Holds what's derived from the rotation too,
+    // so restoring is just a copy rather than redoing the trig.
+    struct State {
+        glm::vec3 position;
+        glm::vec3 scale;
 
-    glm::vec3 forward() const;
-    glm::vec3 left() const;
+        // Euler angles, applied x then y then z. Everything derived from
+        // them is kept up to date whenever they change.
+        glm::vec3 rotation;
+        glm::quat orientation;
+        glm::quat inverse_orientation;
+        glm::vec3 forward;
+        glm::vec3 left;
+    };
 
-    void init(GameObject&) override;
+    // Kept in the world's archetype tables, see ArchetypeStored
+    using ArchetypeData = State;
+
+    [[nodiscard]] inline State state() const { return *m_state; }
+
+    void restore(State const&);
 
 private:
-    Transform(Transform const&) = default;
+    Transform(Transform const&);
     Transform()
-        : m_position(0)
-        , m_scale(1)
-        , m_rotation(0)
-        , m_global_transform_cache(1)
-        , m_local_transform_cache(1)
+        : m_state(State {
+            .position = glm::vec3(0),
+            .scale = glm::vec3(1),
+            .rotation = glm::vec3(0),
+            .orientation = glm::quat(1, 0, 0, 0),
+            .inverse_orientation = glm::quat(1, 0, 0, 0),
+            .forward = glm::vec3(0, 0, -1),
+            .left = glm::vec3(-1, 0, 0),
+        })
+        , m_local_affine_cache(Engine::Affine::identity())
     {
     }
 
-    void on_change(bool global_change = false);
+    void on_change();
+    void on_rotation_change();
 
-    glm::vec3 m_position;
-    glm::vec3 m_scale;
-    glm::vec3 m_rotation;
+    ArchetypeStored<State> m_state;
 
-    GameObject* m_game_object { nullptr };
-    mutable glm::mat4 m_global_transform_cache;
-    mutable glm::mat4 m_local_transform_cache;
-    mutable bool m_is_global_cache_dirty { true };
+    mutable Engine::Affine m_local_affine_cache;
     mutable bool m_is_local_cache_dirty { true };
+
+    // Set once the world has placed this transform in its hierarchy
+    TransformHierarchy* m_hierarchy { nullptr };
+    int m_hierarchy_index { -1 };
 };
 
 }
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "transform_hierarchy.hpp"
+#include "gameobject.hpp"
+#include "transform.hpp"
+#include <algorithm>
+#include <utility>
+using namespace Engine;
+using namespace Object;
+
+// Compacting costs a pass over the arrays, so wait until it pays for itself
+static constexpr size_t s_min_removed_to_compact = 64;
+
+void TransformHierarchy::mark_dirty(int index)
+{
+    m_dirty[index] = true;
+    mark_first_dirty(index);
+}
+
+void TransformHierarchy::mark_first_dirty(int index)
+{
+    auto first = m_first_dirty.load(std::memory_order_relaxed);
+    while (index < first && !m_first_dirty.compare_exchange_weak(first, index, std::memory_order_relaxed)) {
+    }
+}
+
+void TransformHierarchy::insert(GameObject& object, Transform& transform)
+{
+    if (m_is_structure_dirty) {
+        return;
+    }
+
+    // Children are relative to the first transform of their parent
+    auto parent = -1;
+    auto const* parent_object = object.parent();
+    auto const* parent_transform = parent_object ? parent_object->first<Transform>() : nullptr;
+    if (parent_transform) {
+        if (parent_transform->m_hierarchy != this) {
+            mark_structure_dirty();
+            return;
+        }
+        parent = parent_transform->m_hierarchy_index;
+    }
+
+    // Children placed before it would have to move after it
+    if (object.first<Transform>() == &transform) {
+        auto has_placed_children = false;
+        object.for_each_child([&](GameObject& child) {
+            auto const* child_transform = child.first<Transform>();
+            has_placed_children = child_transform && child_transform->m_hierarchy;
+            return has_placed_children ? IteratorDecision::Break : IteratorDecision::Continue;
+        });
+
+        if (has_placed_children) {
+            mark_structure_dirty();
+            return;
+        }
+    }
+
+    mark_first_dirty(add(transform, parent));
+}
+
+void TransformHierarchy::remove(Transform& transform)
+{
+    if (transform.m_hierarchy != this) {
+        return;
+    }
+
+    auto index = transform.m_hierarchy_index;
+    transform.m_hierarchy = nullptr;
+    transform.m_hierarchy_index = -1;
+    m_transforms[index] = nullptr;
+    m_dirty[index] = false;
+    if (m_is_structure_dirty) {
+        return;
+    }
+
+    // Destroyed objects remove their children first, so a parent still
+    // with children is only having the transform taken away
+    if (m_child_counts[index] > 0) {
+        mark_structure_dirty();
+        return;
+    }
+
+    auto parent = m_parents[index];
+    if (parent >= 0) {
+        m_child_counts[parent] -= 1;
+    }
+
+    m_parents[index] = -1;
+    m_removed_count += 1;
+}
+
+void TransformHierarchy::update(GameObject& root)
+{
+    if (m_is_structure_dirty) {
+        rebuild(root);
+    } else if (m_removed_count >= s_min_removed_to_compact && m_removed_count * 2 >= m_transforms.size()) {
+        compact();
+    }
+
+    auto first_dirty = m_first_dirty.load();
+    if (first_dirty == s_clean) {
+        return;
+    }
+
+    // Parents are always earlier, so have already been updated
+    for (auto i = static_cast<size_t>(first_dirty); i < m_transforms.size(); i++) {
+        auto parent = m_parents[i];
+        if (parent >= 0 && m_dirty[parent]) {
+            m_dirty[i] = true;
+        }
+
+        if (!m_dirty[i] || !m_transforms[i]) {
+            continue;
+        }
+
+        auto const& local = m_transforms[i]->local_affine();
+        m_globals[i] = parent >= 0 ? m_globals[parent] * local : local;
+    }
+
+    std::fill(m_dirty.begin() + first_dirty, m_dirty.end(), false);
+    m_first_dirty = s_clean;
+}
+
+glm::mat4 TransformHierarchy::global(int index) const
+{
+    if (index < m_first_dirty.load(std::memory_order_relaxed)) {
+        return m_globals[index].to_mat4();
+    }
+
+    // Everything above the highest changed transform is still up to date
+    auto highest_dirty = -1;
+    for (auto i = index; i >= 0; i = m_parents[i]) {
+        if (m_dirty[i]) {
+            highest_dirty = i;
+        }
+    }
+
+    if (highest_dirty == -1) {
+        return m_globals[index].to_mat4();
+    }
+
+    auto transform = m_transforms[index]->local_affine();
+    for (auto i = index; i != highest_dirty;) {
+        i = m_parents[i];
+        transform = m_transforms[i]->local_affine() * transform;
+    }
+
+    auto parent = m_parents[highest_dirty];
+    if (parent >= 0) {
+        transform = m_globals[parent] * transform;
+    }
+
+    return transform.to_mat4();
+}
+
+int TransformHierarchy::add(Transform& transform, int parent)
+{
+    auto index = static_cast<int>(m_transforms.size());
+    m_transforms.push_back(&transform);
+    m_parents.push_back(parent);
+    m_child_counts.push_back(0);
+    m_globals.push_back(Affine::identity());
+    m_dirty.push_back(true);
+    if (parent >= 0) {
+        m_child_counts[parent] += 1;
+    }
+
+    transform.m_hierarchy = this;
+    transform.m_hierarchy_index = index;
+    return index;
+}
+
+void TransformHierarchy::compact()
+{
+    // Removing gaps keeps the order, so parents stay before children
+    std::vector<int32_t> new_indices(m_transforms.size(), -1);
+    auto first_dirty = m_first_dirty.load();
+    auto new_first_dirty = s_clean;
+    size_t count = 0;
+    for (size_t i = 0; i < m_transforms.size(); i++) {
+        auto* transform = m_transforms[i];
+        if (!transform) {
+            continue;
+        }
+
+        if (new_first_dirty == s_clean && static_cast<int>(i) >= first_dirty) {
+            new_first_dirty = static_cast<int>(count);
+        }
+
+        auto parent = m_parents[i];
+        new_indices[i] = static_cast<int32_t>(count);
+        m_transforms[count] = transform;
+        m_parents[count] = parent >= 0 ? new_indices[parent] : -1;
+        m_child_counts[count] = m_child_counts[i];
+        m_globals[count] = m_globals[i];
+        m_dirty[count] = m_dirty[i];
+        transform->m_hierarchy_index = static_cast<int>(count);
+        count += 1;
+    }
+
+    m_transforms.resize(count);
+    m_parents.resize(count);
+    m_child_counts.resize(count);
+    m_globals.resize(count);
+    m_dirty.resize(count);
+    m_removed_count = 0;
+    m_first_dirty = new_first_dirty;
+}
+
+void TransformHierarchy::rebuild(GameObject& root)
+{
+    for (auto* transform : m_transforms) {
+        if (transform) {
+            transform->m_hierarchy = nullptr;
+            transform->m_hierarchy_index = -1;
+        }
+    }
+
+    m_transforms.clear();
+    m_parents.clear();
+    m_child_counts.clear();
+    m_globals.clear();
+    m_dirty.clear();
+    m_removed_count = 0;
+
+    // Walk one depth at a time, so each level follows the one above it.
+    // Children are relative to the first transform of their parent.
+    std::vector<std::pair<GameObject*, int>> level = { { &root, -1 } };
+    std::vector<std::pair<GameObject*, int>> next_level;
+    while (!level.empty()) {
+        for (auto [object, parent] : level) {
+            auto first = -1;
+            for (auto* transform : object->get<Transform>()) {
+                auto index = add(*transform, parent);
+                if (first == -1) {
+                    first = index;
+                }
+            }
+
+            object->for_each_child([&, first = first](GameObject& child) {
+                next_level.emplace_back(&child, first);
+                return IteratorDecision::Continue;
+            });
+        }
+
+        std::swap(level, next_level);
+        next_level.clear();
+    }
+
+    m_is_structure_dirty = false;
+    m_first_dirty = 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "engine/math/affine.hpp"
+#include "forward.hpp"
+#include <atomic>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <vector>
+
+namespace Object {
+
+// Every transform in the world, flattened so parents always come before
+// their children. Global matrices are then updated in a single pass over
+// the arrays, rather than recursing up the tree per transform.
+class TransformHierarchy {
+public:
+    // Rebuilt from the whole tree on the next update
+    inline void mark_structure_dirty() { m_is_structure_dirty = true; }
+    [[nodiscard]] inline bool is_structure_dirty() const { return m_is_structure_dirty; }
+
+    // New transforms go on the end, after their parent, and removed ones
+    // leave a gap until there are enough to compact. Only changes which
+    // would reorder existing transforms fall back to a rebuild.
+    void insert(GameObject&, Transform&);
+    void remove(Transform&);
+
+    void mark_dirty(int index);
+    void update(GameObject& root);
+
+    // Up to date as of the last update, unless it or a parent has changed
+    // since, then the changed part of the chain is worked out again
+    [[nodiscard]] glm::mat4 global(int index) const;
+
+private:
+    static constexpr int s_clean = std::numeric_limits<int>::max();
+
+    void mark_first_dirty(int index);
+    void rebuild(GameObject& root);
+    void compact();
+    int add(Transform&, int parent);
+
+    std::vector<Transform*> m_transforms;
+    std::vector<int32_t> m_parents;
+    std::vector<int32_t> m_child_counts;
+    std::vector<Engine::Affine> m_globals;
+    std::vector<uint8_t> m_dirty;
+    size_t m_removed_count { 0 };
+
+    bool m_is_structure_dirty { true };
+
+    // Everything before it is up to date, children always come after
+    // their parents. Lowered by systems running in parallel.
+    std::atomic<int> m_first_dirty { 0 };
+};
+
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "world.hpp"
+#include "attributes.hpp"
+#include "engine/assets/thread_pool.hpp"
+#include "transform.hpp"
+#include <algorithm>
+using namespace Engine;
+using namespace Object;
+
+static constexpr size_t s_chunk_size = 64;
+
+World::World()
+{
+    m_world = this;
+}
+
+World::~World() = default;
+
+void World::update(float delta)
+{
+    run_systems(Phase::Update, delta);
+    GameObject::update(delta);
+}
+
+void World::step_physics(float by)
+{
+    run_systems(Phase::StepPhysics, by);
+    GameObject::step_physics(by);
+}
+
+void World::update_transforms()
+{
+    m_transform_hierarchy.update(*this);
+}
+
+void World::flush_destroyed()
+{
+    // Listeners may destroy more objects, those go in the next flush
+    auto destroyed = std::move(m_destroyed);
+    m_destroyed.clear();
+
+    for (auto handle : destroyed) {
+        // Already gone if a parent was destroyed too
+        auto* object = resolve(handle);
+        if (!object) {
+            continue;
+        }
+
+        release(*object);
+        std::erase_if(object->m_parent->m_children, [object](auto const& child) {
+            return child.get() == object;
+        });
+    }
+}
+
+std::vector<GameObject*> World::tagged(Tag tag, GameObject const& under) const
+{
+    if (tag == UNTAGGED) {
+        return {};
+    }
+
+    auto const& tagged_below = m_tagged[tag];
+    auto it = tagged_below.find(&under);
+    if (it == tagged_below.end()) {
+        return {};
+    }
+
+    return it->second;
+}
+
+void World::add_listener(WorldListener& listener)
+{
+    m_listeners.push_back(&listener);
+    notify_existing(listener, *this);
+}
+
+void World::remove_listener(WorldListener& listener)
+{
+    std::erase(m_listeners, &listener);
+}
+
+void World::notify_existing(WorldListener& listener, GameObject& object)
+{
+    for (auto& component : object.m_components) {
+        listener.on_component_added(object, *component);
+    }
+
+    for (auto& child : object.m_children) {
+        notify_existing(listener, *child);
+    }
+}
+
+std::vector<World::Stage> World::build_stages(Phase phase) const
+{
+    std::vector<Stage> stages;
+    std::vector<std::pair<System*, size_t>> placed;
+    for (auto const& system : m_systems) {
+        auto runs = phase == Phase::Update ? system->has_update() : system->has_step_physics();
+        if (!runs) {
+            continue;
+        }
+
+        // Go after the last earlier system this one conflicts with
+        size_t stage = 0;
+        for (auto const& [other, other_stage] : placed) {
+            if (system->conflicts_with(*other)) {
+                stage = std::max(stage, other_stage + 1);
+            }
+        }
+
+        if (stages.size() <= stage) {
+            stages.resize(stage + 1);
+        }
+        stages[stage].push_back(system.get());
+        placed.emplace_back(system.get(), stage);
+    }
+
+    return stages;
+}
+
+void World::run_systems(Phase phase, float delta)
+{
+    if (m_are_stages_dirty) {
+        m_update_stages = build_stages(Phase::Update);
+        m_step_physics_stages = build_stages(Phase::StepPhysics);
+        m_are_stages_dirty = false;
+    }
+
+    auto const& stages = phase == Phase::Update ? m_update_stages : m_step_physics_stages;
+    for (auto const& stage : stages) {
+        m_jobs.clear();
+        for (auto* system : stage) {
+            auto system_delta = phase == Phase::Update ? system->begin_update(delta) : delta;
+            auto size = system->size();
+            auto chunk_size = system->is_chunked() ? s_chunk_size : size;
+            for (size_t begin = 0; begin < size; begin += chunk_size) {
+                auto end = std::min(begin + chunk_size, size);
+                m_jobs.push_back([system, phase, system_delta, begin, end] {
+                    if (phase == Phase::Update) {
+                        system->update(system_delta, begin, end);
+                    } else {
+                        system->step_physics(system_delta, begin, end);
+                    }
+                });
+            }
+        }
+
+        ThreadPool::run_parallel(m_jobs);
+    }
+}
+
+void World::on_component_added(GameObject& object, Component& component)
+{
+    index(object, component);
+    if (!component.is_stored_in_archetype()) {
+        return;
+    }
+
+    Archetype::Signature signature;
+    if (object.m_archetype) {
+        signature = object.m_archetype->signature();
+    }
+
+    // Only the first component of each type gets a column
+    auto type_index = component.type_index();
+    auto position = std::lower_bound(signature.begin(), signature.end(), type_index);
+    if (position != signature.end() && *position == type_index) {
+        return;
+    }
+
+    signature.insert(position, type_index);
+    move_to_archetype(object, signature);
+}
+
+void World::on_component_removed(GameObject& object, Component& component)
+{
+    unindex(object, component);
+
+    // Its data has to leave the table while the component's still there,
+    // the object's put back once it's gone
+    if (component.is_stored_in_archetype()) {
+        remove_from_archetype(object);
+    }
+}
+
+void World::on_object_added(GameObject& object)
+{
+    for (auto const& component : object.m_components) {
+        index(object, *component);
+    }
+
+    update_archetype(object);
+}
+
+void World::on_enabled_changed(GameObject& object)
+{
+    update_activity(object, object.is_active());
+    for (auto* listener : m_listeners) {
+        listener->on_enabled_changed(object);
+    }
+}
+
+void World::on_object_destroyed(GameObject& object)
+{
+    m_destroyed.push_back(object.m_handle);
+}
+
+Handle World::register_object(GameObject& object)
+{
+    if (m_free_slots.empty()) {
+        m_slots.push_back(Slot { &object, 1 });
+        return Handle { static_cast<uint32_t>(m_slots.size() - 1), 1 };
+    }
+
+    auto index = m_free_slots.back();
+    m_free_slots.pop_back();
+
+    auto& slot = m_slots[index];
+    slot.object = &object;
+    return Handle { index, slot.generation };
+}
+
+void World::release(GameObject& object)
+{
+    for (auto& child : object.m_children) {
+        release(*child);
+    }
+
+    for (auto& component : object.m_components) {
+        unindex(object, *component);
+    }
+
+    remove_from_archetype(object);
+    for (auto* listener : m_listeners) {
+        listener->on_object_destroyed(object);
+    }
+
+    // Outstanding handles to the object no longer match
+    auto& slot = m_slots[object.m_handle.index];
+    slot.object = nullptr;
+    slot.generation += 1;
+    m_free_slots.push_back(object.m_handle.index);
+}
+
+void World::index(GameObject& object, Component& component)
+{
+    schedule(object, component);
+
+    auto type_index = component.type_index();
+    if (type_index == Transform::static_type_index()) {
+        m_transform_hierarchy.insert(object, static_cast<Transform&>(component));
+    }
+
+    // Listed under each ancestor, so finding the ones below an object is a
+    // single lookup. Objects are only ever added under their final parent.
+    if (type_index == Attributes::static_type_index()) {
+        auto const& tags = static_cast<Attributes const&>(component).tags();
+        for (size_t tag = 0; tag < MAX_TAGS; tag++) {
+            if (!tags.test(tag)) {
+                continue;
+            }
+
+            for (auto const* ancestor = object.m_parent; ancestor; ancestor = ancestor->m_parent) {
+                m_tagged[tag][ancestor].push_back(&object);
+            }
+        }
+    }
+
+    for (auto* listener : m_listeners) {
+        listener->on_component_added(object, component);
+    }
+}
+
+void World::unindex(GameObject& object, Component& component)
+{
+    for (auto* listener : m_listeners) {
+        listener->on_component_removed(object, component);
+    }
+
+    if (component.m_is_scheduled) {
+        auto* system = m_systems_by_type[component.type_index()];
+        auto* moved_component = system->remove(component.m_system_index);
+        if (moved_component) {
+            moved_component->m_system_index = component.m_system_index;
+        }
+        component.m_is_scheduled = false;
+    }
+
+    auto type_index = component.type_index();
+    if (type_index == Transform::static_type_index()) {
+        m_transform_hierarchy.remove(static_cast<Transform&>(component));
+    }
+
+    if (type_index == Attributes::static_type_index()) {
+        auto const& tags = static_cast<Attributes const&>(component).tags();
+        for (size_t tag = 0; tag < MAX_TAGS; tag++) {
+            if (!tags.test(tag)) {
+                continue;
+            }
+
+            // Children are released before their parents, so every
+            // ancestor is still there. Empty lists are dropped, as the
+            // ancestor's memory may be reused by a new object.
+            auto& tagged_below = m_tagged[tag];
+            for (auto const* ancestor = object.m_parent; ancestor; ancestor = ancestor->m_parent) {
+                auto it = tagged_below.find(ancestor);
+                if (it == tagged_below.end()) {
+                    continue;
+                }
+
+                std::erase(it->second, &object);
+                if (it->second.empty()) {
+                    tagged_below.erase(it);
+                }
+            }
+        }
+    }
+}
+
+void World::schedule(GameObject& object, Component& component)
+{
+    auto type_index = component.type_index();
+    if (type_index >= m_systems_by_type.size() || !m_systems_by_type[type_index]) {
+        return;
+    }
+
+    component.m_system_index = m_systems_by_type[type_index]->add(object, component);
+    component.m_is_scheduled = true;
+}
+
+void World::schedule_existing(GameObject& object, ComponentTypeId type_index)
+{
+    for (auto& component : object.m_components) {
+        if (component->type_index() == type_index) {
+            schedule(object, *component);
+        }
+    }
+
+    for (auto& child : object.m_children) {
+        schedule_existing(*child, type_index);
+    }
+}
+
+void World::update_activity(GameObject& object, bool is_active)
+{
+    for (auto& component : object.m_components) {
+        if (component->m_is_scheduled) {
+            m_systems_by_type[component->type_index()]->set_active(component->m_system_index, is_active);
+        }
+    }
+
+    for (auto& child : object.m_children) {
+        update_activity(*child, is_active && child->m_enabled);
+    }
+}
+
+void World::update_archetype(GameObject& object)
+{
+    Archetype::Signature signature;
+    for (auto const& component : object.m_components) {
+        if (component->is_stored_in_archetype()) {
+            signature.push_back(component->type_index());
+        }
+    }
+
+    std::sort(signature.begin(), signature.end());
+    signature.erase(std::unique(signature.begin(), signature.end()), signature.end());
+    if (signature.empty()) {
+        remove_from_archetype(object);
+        return;
+    }
+
+    move_to_archetype(object, signature);
+}
+
+void World::move_to_archetype(GameObject& object, Archetype::Signature const& signature)
+{
+    remove_from_archetype(object);
+
+    std::vector<Component*> components;
+    components.reserve(signature.size());
+    for (auto type_index : signature) {
+        components.push_back(object.first_of_type(type_index));
+    }
+
+    auto& archetype = find_or_create_archetype(signature, components);
+    object.m_archetype = &archetype;
+    object.m_archetype_row = archetype.add(object, components);
+}
+
+void World::remove_from_archetype(GameObject& object)
+{
+    if (!object.m_archetype) {
+        return;
+    }
+
+    auto* moved_object = object.m_archetype->remove(object.m_archetype_row);
+    if (moved_object) {
+        moved_object->m_archetype_row = object.m_archetype_row;
+    }
+
+    object.m_archetype = nullptr;
+    object.m_archetype_row = 0;
+}
+
+Archetype& World::find_or_create_archetype(Archetype::Signature const& signature, std::vector<Component*> const& components)
+{
+    for (auto& archetype : m_archetypes) {
+        if (archetype->signature() == signature) {
+            return *archetype;
+        }
+    }
+
+    std::vector<size_t> data_sizes;
+    data_sizes.reserve(components.size());
+    for (auto const* component : components) {
+        data_sizes.push_back(component->archetype_data_size());
+    }
+
+    m_archetypes.push_back(std::make_unique<Archetype>(signature, std::move(data_sizes)));
+    return *m_archetypes.back();
+}
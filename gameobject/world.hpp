@@ -6,13 +6,230 @@
 
 #pragma once
 
+#include "archetype.hpp"
 #include "gameobject.hpp"
+#include "handle.hpp"
+#include "system.hpp"
+#include "tag.hpp"
+#include "transform_hierarchy.hpp"
+#include "world_listener.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Object {
 
 class World : public GameObject {
+    friend GameObject;
+
 public:
-    World() = default;
+    World();
+    ~World() override;
+
+    // Systems run before any component which doesn't have one. Systems
+    // which don't conflict over the types they access may run at the same
+    // time, otherwise they run in the order they're added.
+    template<typename T, typename... Access>
+    void add_system(Access... access)
+    {
+        auto type_index = T::static_type_index();
+        if (m_systems_by_type.size() <= type_index) {
+            m_systems_by_type.resize(type_index + 1, nullptr);
+        }
+
+        assert(!m_systems_by_type[type_index]);
+        auto system = std::make_unique<ComponentSystem<T>>();
+        (system->declare(access), ...);
+
+        m_systems_by_type[type_index] = system.get();
+        m_systems.push_back(std::move(system));
+        m_are_stages_dirty = true;
+        schedule_existing(*this, type_index);
+    }
+
+    void update(float delta);
+    void step_physics(float by);
+
+    // Brings every global transform up to date, ready for rendering
+    void update_transforms();
+
+    // Null once the object has been destroyed
+    [[nodiscard]] inline GameObject* resolve(Handle handle) const
+    {
+        if (handle.index >= m_slots.size() || m_slots[handle.index].generation != handle.generation) {
+            return nullptr;
+        }
+
+        return m_slots[handle.index].object;
+    }
+
+    // Frees every object destroyed since the last flush, once nothing is
+    // iterating over the world. Anything referring to another object past
+    // the end of a tick should hold a handle to it rather than a pointer.
+    void flush_destroyed();
+
+    // Every object with the tag somewhere below the given object, in the
+    // order they were added to the world
+    [[nodiscard]] std::vector<GameObject*> tagged(Tag, GameObject const& under) const;
+
+    // The listener is first told about every component already in the world
+    void add_listener(WorldListener&);
+    void remove_listener(WorldListener&);
+
+    template<typename... Ts>
+    class Query {
+        friend World;
+
+    public:
+        // Visits the first component of each type on every object that
+        // has all of them, regardless of whether the object is active.
+        template<typename Func>
+        void for_each(Func callback) const
+        {
+            for (auto const* archetype : m_archetypes) {
+                auto columns = std::array {
+                    archetype->column(archetype->column_index(Ts::static_type_index()))...
+                };
+
+                auto decision = [&]<size_t... I>(std::index_sequence<I...>) {
+                    for (size_t row = 0; row < archetype->size(); row++) {
+                        if (callback(archetype->object(row), static_cast<Ts&>(*columns[I][row])...) == IteratorDecision::Break) {
+                            return IteratorDecision::Break;
+                        }
+                    }
+
+                    return IteratorDecision::Continue;
+                }(std::index_sequence_for<Ts...> {});
+
+                if (decision == IteratorDecision::Break) {
+                    return;
+                }
+            }
+        }
+
+        // Visits the ArchetypeData of each type on every object that has
+        // all of them, reading each table's chunks linearly rather than
+        // going through the components. Read only, changes go through the
+        // components so whatever depends on them hears about it.
+        template<typename Func>
+        void for_each_data(Func callback) const
+        {
+            static_assert((has_archetype_data<Ts> && ...), "Component type has no ArchetypeData");
+
+            for (auto const* archetype : m_archetypes) {
+                auto indices = std::array { archetype->column_index(Ts::static_type_index())... };
+                for (size_t chunk = 0; chunk < archetype->chunk_count(); chunk++) {
+                    auto decision = [&]<size_t... I>(std::index_sequence<I...>) {
+                        auto data = std::tuple {
+                            static_cast<typename Ts::ArchetypeData const*>(archetype->chunk(indices[I], chunk))...
+                        };
+
+                        auto rows = archetype->rows_in_chunk(chunk);
+                        for (size_t row = 0; row < rows; row++) {
+                            if (callback(std::get<I>(data)[row]...) == IteratorDecision::Break) {
+                                return IteratorDecision::Break;
+                            }
+                        }
+
+                        return IteratorDecision::Continue;
+                    }(std::index_sequence_for<Ts...> {});
+
+                    if (decision == IteratorDecision::Break) {
+                        return;
+                    }
+                }
+            }
+        }
+
+    private:
+        explicit Query(std::vector<Archetype const*> archetypes)
+            : m_archetypes(std::move(archetypes))
+        {
+        }
+
+        std::vector<Archetype const*> m_archetypes;
+    };
+
+    template<typename... Ts>
+    Query<Ts...> query() const
+    {
+        static_assert((Ts::stored_in_archetype && ...), "Component type is not stored in archetypes");
+
+        Archetype::Signature types = { Ts::static_type_index()... };
+        std::sort(types.begin(), types.end());
+
+        std::vector<Archetype const*> archetypes;
+        for (auto const& archetype : m_archetypes) {
+            if (archetype->size() > 0 && archetype->contains(types)) {
+                archetypes.push_back(archetype.get());
+            }
+        }
+
+        return Query<Ts...>(std::move(archetypes));
+    }
+
+private:
+    void on_component_added(GameObject&, Component&);
+    void on_component_removed(GameObject&, Component&);
+    void on_object_added(GameObject&);
+    void on_enabled_changed(GameObject&);
+    void on_object_destroyed(GameObject&);
+
+    Handle register_object(GameObject&);
+    void release(GameObject&);
+
+    void index(GameObject&, Component&);
+    void unindex(GameObject&, Component&);
+    void schedule(GameObject&, Component&);
+    void schedule_existing(GameObject&, ComponentTypeId);
+    void update_activity(GameObject&, bool is_active);
+    void notify_existing(WorldListener&, GameObject&);
+
+    enum class Phase {
+        Update,
+        StepPhysics,
+    };
+
+    // Systems within a stage don't conflict, so can run in parallel
+    using Stage = std::vector<System*>;
+
+    std::vector<Stage> build_stages(Phase) const;
+    void run_systems(Phase, float delta);
+
+    void update_archetype(GameObject&);
+    void move_to_archetype(GameObject&, Archetype::Signature const&);
+    void remove_from_archetype(GameObject&);
+    Archetype& find_or_create_archetype(Archetype::Signature const&, std::vector<Component*> const&);
+
+    struct Slot {
+        GameObject* object;
+        uint32_t generation;
+    };
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<Handle> m_destroyed;
+
+    std::vector<std::unique_ptr<Archetype>> m_archetypes;
+    TransformHierarchy m_transform_hierarchy;
+
+    // Each tagged object is listed under every one of its ancestors
+    using TaggedBelow = std::unordered_map<GameObject const*, std::vector<GameObject*>>;
+    std::array<TaggedBelow, MAX_TAGS> m_tagged;
+
+    std::vector<WorldListener*> m_listeners;
+    std::vector<std::unique_ptr<System>> m_systems;
+    std::vector<System*> m_systems_by_type;
+    std::vector<Stage> m_update_stages;
+    std::vector<Stage> m_step_physics_stages;
+    std::vector<std::function<void()>> m_jobs;
+    bool m_are_stages_dirty { false };
 };
 
 }
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include "forward.hpp"
+
+namespace Object {
+
+// Told about changes to a world as they happen, so anything keeping its
+// own lists of components never has to rescan the whole tree.
+class WorldListener {
+public:
+    virtual ~WorldListener() = default;
+
+    virtual void on_component_added(GameObject&, Component&) { }
+
+    // Called while the component still exists
+    virtual void on_component_removed(GameObject&, Component&) { }
+
+    // Affects whether everything below the object is active
+    virtual void on_enabled_changed(GameObject&) { }
+
+    // Called once each of its components has been removed, just before
+    // the object is freed
+    virtual void on_object_destroyed(GameObject&) { }
+};
+
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "gameobject/physics/physics_body_2d.hpp"
+#include "gameobject/prefab.hpp"
+#include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <vector>
+using namespace Object;
+
+static GameObject& make_car(GameObject& parent, float x)
+{
+    auto& car = parent.add_child();
+    car.add_component<Transform>().set_position(glm::vec3(x, 0, 0));
+    car.add_component<PhysicsBody2D>(glm::vec2(6, 4), 1.0f, 1.0f, 0.2f).apply_force(glm::vec2(x, 0));
+    return car;
+}
+
+static size_t count_data(World const& world)
+{
+    size_t count = 0;
+    world.query<Transform, PhysicsBody2D>().for_each_data([&](Transform::State const&, PhysicsBody2D::State const&) {
+        count += 1;
+        return IteratorDecision::Continue;
+    });
+
+    return count;
+}
+
+TEST(archetype_data_follows_rows)
+{
+    World world;
+
+    // Enough to span a few chunks
+    constexpr int car_count = Archetype::rows_per_chunk * 2 + 10;
+    std::vector<GameObject*> cars;
+    for (int i = 0; i < car_count; i++) {
+        cars.push_back(&make_car(world, static_cast<float>(i)));
+    }
+
+    // Each row's data matches its own object, read straight from the chunks
+    CHECK(count_data(world) == car_count);
+    world.query<Transform, PhysicsBody2D>().for_each_data([](Transform::State const& transform, PhysicsBody2D::State const& body) {
+        CHECK(transform.position.x == body.velocity.x);
+        return IteratorDecision::Continue;
+    });
+
+    // Removing rows swaps others into their place, whose components must
+    // follow their data
+    for (int i = 0; i < car_count; i += 3) {
+        cars[i]->destroy();
+    }
+    world.flush_destroyed();
+
+    for (int i = 0; i < car_count; i++) {
+        if (i % 3 == 0) {
+            continue;
+        }
+
+        CHECK(cars[i]->first<Transform>()->position().x == static_cast<float>(i));
+        CHECK(cars[i]->first<PhysicsBody2D>()->velocity().x == static_cast<float>(i));
+    }
+
+    // Changes through the components are what queries see
+    cars[1]->first<Transform>()->set_position(glm::vec3(-1, 0, 0));
+    cars[1]->first<PhysicsBody2D>()->apply_force(glm::vec2(-2, 0));
+    bool has_seen_change = false;
+    world.query<Transform, PhysicsBody2D>().for_each_data([&](Transform::State const& transform, PhysicsBody2D::State const& body) {
+        has_seen_change = transform.position.x == -1 && body.velocity.x == -1;
+        return has_seen_change ? IteratorDecision::Break : IteratorDecision::Continue;
+    });
+    CHECK(has_seen_change);
+}
+
+TEST(archetype_data_outside_tables)
+{
+    World world;
+    auto& car = world.add_child();
+    auto& body = car.add_component<PhysicsBody2D>(glm::vec2(6, 4), 1.0f, 1.0f, 0.2f);
+    body.apply_force(glm::vec2(3, 0));
+
+    // Changing archetype moves the data between tables
+    car.add_component<Transform>().set_position(glm::vec3(3, 0, 0));
+    auto& other = make_car(world, 4);
+    CHECK(body.velocity().x == 3);
+    CHECK(count_data(world) == 2);
+
+    // A removed component's data goes back to it, and the rest carry on in
+    // their new table
+    auto& transform = *car.first<Transform>();
+    car.remove_component(body);
+    CHECK(transform.position().x == 3);
+    CHECK(count_data(world) == 1);
+    CHECK(other.first<PhysicsBody2D>()->velocity().x == 4);
+
+    // Prefabs copy the data out of the table, instances get their own rows
+    auto prefab = Prefab::construct(other);
+    other.first<PhysicsBody2D>()->apply_force(glm::vec2(1, 0));
+    auto& instance = prefab->instantiate(world);
+    CHECK(instance.first<PhysicsBody2D>()->velocity().x == 4);
+    CHECK(other.first<PhysicsBody2D>()->velocity().x == 5);
+    CHECK(count_data(world) == 2);
+}
+
+TEST(archetype_data_cost)
+{
+    // Each car's parts have transforms too, like the bumper cars, so the
+    // cars' own are spread through the pool
+    World world;
+    for (int i = 0; i < 20000; i++) {
+        auto& car = make_car(world, static_cast<float>(i % 7));
+        for (int j = 0; j < 16; j++) {
+            car.add_child().add_component<Transform>();
+        }
+    }
+
+    constexpr int iterations = 20;
+    size_t moving_forward = 0;
+    Test::measure("for_each over 20000 cars", iterations, [&] {
+        for (int i = 0; i < iterations; i++) {
+            world.query<Transform, PhysicsBody2D>().for_each([&](GameObject&, Transform& transform, PhysicsBody2D& body) {
+                moving_forward += glm::dot(transform.forward(), glm::vec3(body.velocity().x, 0, body.velocity().y)) > 0;
+                return IteratorDecision::Continue;
+            });
+        }
+    });
+
+    size_t moving_forward_data = 0;
+    Test::measure("for_each_data over 20000 cars", iterations, [&] {
+        for (int i = 0; i < iterations; i++) {
+            world.query<Transform, PhysicsBody2D>().for_each_data([&](Transform::State const& transform, PhysicsBody2D::State const& body) {
+                moving_forward_data += glm::dot(transform.forward, glm::vec3(body.velocity.x, 0, body.velocity.y)) > 0;
+                return IteratorDecision::Continue;
+            });
+        }
+    });
+
+    CHECK(moving_forward == moving_forward_data);
+}
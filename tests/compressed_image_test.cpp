@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "engine/graphics/texture/compressed_image.hpp"
+#include "test.hpp"
+#include <GL/glew.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <sstream>
+#include <stb_image.h>
+using namespace Engine;
+
+template<typename T>
+static void write(std::ostream& stream, T value)
+{
+    stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+// A KTX file the way tools/texture_compressor.py writes them
+static std::string make_ktx(uint32_t format, int width, int height, int level_count, std::string_view key_value_data = "")
+{
+    std::ostringstream stream;
+    std::array<uint8_t, 12> identifier = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    stream.write(reinterpret_cast<char const*>(identifier.data()), identifier.size());
+    for (uint32_t field : { 0x04030201u, 0u, 1u, 0u, format, 0u, uint32_t(width), uint32_t(height), 0u, 0u, 1u, uint32_t(level_count), uint32_t(key_value_data.size()) }) {
+        write(stream, field);
+    }
+    stream << key_value_data;
+
+    auto block_size = format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ? 8 : 16;
+    for (int level = 0; level < level_count; level++) {
+        auto blocks_across = (std::max(width >> level, 1) + 3) / 4;
+        auto blocks_down = (std::max(height >> level, 1) + 3) / 4;
+        auto size = blocks_across * blocks_down * block_size;
+        write(stream, uint32_t(size));
+        for (size_t i = 0; i < size; i++) {
+            stream.put(static_cast<char>(level * 16 + i % 16));
+        }
+    }
+
+    return stream.str();
+}
+
+TEST(compressed_image_read)
+{
+    std::istringstream stream(make_ktx(GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 8, 6, 4, std::string_view("key\0val\0", 8)));
+    CompressedImage image;
+    CHECK(CompressedImage::read(stream, "test.ktx", image));
+    CHECK(image.format() == GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+    CHECK(image.width() == 8);
+    CHECK(image.height() == 6);
+    CHECK(image.level_count() == 4);
+
+    // Levels smaller than a block still take up a whole one
+    std::array<std::array<int, 3>, 4> expected = { { { 8, 6, 32 }, { 4, 3, 8 }, { 2, 1, 8 }, { 1, 1, 8 } } };
+    CHECK(image.levels().size() == 4);
+    for (size_t i = 0; i < image.levels().size(); i++) {
+        auto const& level = image.levels()[i];
+        CHECK(level.index == int(i));
+        CHECK(level.width == expected[i][0]);
+        CHECK(level.height == expected[i][1]);
+        CHECK(level.data.size() == size_t(expected[i][2]));
+        CHECK(level.data.back() == i * 16 + (level.data.size() - 1) % 16);
+    }
+}
+
+TEST(compressed_image_read_levels)
+{
+    std::istringstream stream(make_ktx(GL_COMPRESSED_RG_RGTC2, 16, 16, 5));
+    CompressedImage image;
+    CHECK(CompressedImage::read_header(stream, "test.ktx", image));
+    CHECK(image.levels().empty());
+
+    CHECK(image.read_levels(stream, "test.ktx", 2, 4));
+    CHECK(image.levels().size() == 2);
+    CHECK(image.levels()[0].index == 2);
+    CHECK(image.levels()[0].data.size() == 16);
+    CHECK(image.levels()[0].data.front() == 2 * 16);
+    CHECK(image.levels()[1].index == 3);
+}
+
+TEST(compressed_image_rejects_invalid)
+{
+    CompressedImage image;
+
+    std::istringstream not_ktx("Not a KTX file, just some text that's long enough for a header");
+    CHECK(!CompressedImage::read(not_ktx, "not_ktx", image));
+
+    std::istringstream uncompressed(make_ktx(GL_RGBA, 4, 4, 1));
+    CHECK(!CompressedImage::read(uncompressed, "uncompressed", image));
+
+    auto data = make_ktx(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 32, 32, 6);
+    std::istringstream truncated(data.substr(0, data.size() - 4));
+    CHECK(!CompressedImage::read(truncated, "truncated", image));
+}
+
+#ifdef COMPRESSED_TEXTURE_DIR
+
+// Decodes blocks back to pixels, to check what the compressor produced
+// against the image it came from
+
+static glm::vec3 unpack_565(uint16_t colour)
+{
+    return glm::vec3((colour >> 11) & 31, (colour >> 5) & 63, colour & 31) / glm::vec3(31, 63, 31) * 255.0f;
+}
+
+static void decode_bc1(uint8_t const* block, std::array<glm::vec3, 16>& pixels)
+{
+    uint16_t c0, c1;
+    uint32_t indicies;
+    std::memcpy(&c0, block, 2);
+    std::memcpy(&c1, block + 2, 2);
+    std::memcpy(&indicies, block + 4, 4);
+
+    std::array<glm::vec3, 4> palette;
+    palette[0] = unpack_565(c0);
+    palette[1] = unpack_565(c1);
+    if (c0 > c1) {
+        palette[2] = (palette[0] * 2.0f + palette[1]) / 3.0f;
+        palette[3] = (palette[0] + palette[1] * 2.0f) / 3.0f;
+    } else {
+        palette[2] = (palette[0] + palette[1]) / 2.0f;
+        palette[3] = glm::vec3(0);
+    }
+
+    for (int i = 0; i < 16; i++) {
+        pixels[i] = palette[(indicies >> (i * 2)) & 3];
+    }
+}
+
+static void decode_bc4(uint8_t const* block, std::array<float, 16>& values)
+{
+    float v0 = block[0];
+    float v1 = block[1];
+    std::array<float, 8> palette = { v0, v1 };
+    for (int i = 1; i < 7; i++) {
+        palette[i + 1] = block[0] > block[1]
+            ? ((7 - i) * v0 + i * v1) / 7.0f
+            : (i < 5 ? ((5 - i) * v0 + i * v1) / 5.0f : (i == 5 ? 0.0f : 255.0f));
+    }
+
+    uint64_t indicies = 0;
+    std::memcpy(&indicies, block + 2, 6);
+    for (int i = 0; i < 16; i++) {
+        values[i] = palette[(indicies >> (i * 3)) & 7];
+    }
+}
+
+// Peak signal to noise ratio of the decoded top level against the source,
+// over the first channel_count channels
+static double compare(CompressedImage const& image, std::string const& source_path, int channel_count)
+{
+    int width, height, channels;
+    auto* source = stbi_load(source_path.c_str(), &width, &height, &channels, 3);
+    CHECK(source);
+    if (!source) {
+        return 0;
+    }
+    CHECK(width == image.width() && height == image.height());
+
+    auto const& data = image.levels().front().data;
+    auto is_bc5 = image.format() == GL_COMPRESSED_RG_RGTC2;
+    auto block_size = is_bc5 ? 16 : 8;
+    auto blocks_across = (width + 3) / 4;
+
+    double squared_error = 0;
+    size_t samples = 0;
+    for (int block_y = 0; block_y < (height + 3) / 4; block_y++) {
+        for (int block_x = 0; block_x < blocks_across; block_x++) {
+            auto const* block = data.data() + (block_y * blocks_across + block_x) * block_size;
+
+            std::array<glm::vec3, 16> pixels;
+            if (is_bc5) {
+                std::array<float, 16> red, green;
+                decode_bc4(block, red);
+                decode_bc4(block + 8, green);
+                for (int i = 0; i < 16; i++) {
+                    pixels[i] = glm::vec3(red[i], green[i], 0);
+                }
+            } else {
+                decode_bc1(block, pixels);
+            }
+
+            for (int i = 0; i < 16; i++) {
+                auto x = block_x * 4 + i % 4;
+                auto y = block_y * 4 + i / 4;
+                if (x >= width || y >= height) {
+                    continue;
+                }
+
+                for (int channel = 0; channel < channel_count; channel++) {
+                    auto error = pixels[i][channel] - source[(y * width + x) * 3 + channel];
+                    squared_error += error * error;
+                    samples += 1;
+                }
+            }
+        }
+    }
+
+    stbi_image_free(source);
+    auto mean_squared_error = squared_error / samples;
+    return 10.0 * std::log10(255.0 * 255.0 / std::max(mean_squared_error, 1e-9));
+}
+
+static void check_round_trip(std::string_view name, uint32_t format, int channel_count)
+{
+    auto path = std::string(COMPRESSED_TEXTURE_DIR) + std::string(CompressedImage::name_for(name));
+    std::ifstream stream(path, std::ios::binary);
+    CompressedImage image;
+    CHECK(CompressedImage::read(stream, path, image));
+    if (image.levels().empty()) {
+        return;
+    }
+
+    CHECK(image.format() == format);
+    CHECK(image.level_count() == int(std::floor(std::log2(std::max(image.width(), image.height())))) + 1);
+    for (auto const& level : image.levels()) {
+        CHECK(level.data.size() == image.level_size(level.index));
+    }
+
+    auto psnr = compare(image, std::string(SOURCE_TEXTURE_DIR) + std::string(name), channel_count);
+    std::cout << "  " << name << ": " << psnr << "dB\n";
+    CHECK(psnr > 30.0);
+}
+
+TEST(compressed_image_round_trip)
+{
+    check_round_trip("/textures/wood/wood.jpg", GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 3);
+    check_round_trip("/textures/wood/wood_normal.jpg", GL_COMPRESSED_RG_RGTC2, 2);
+}
+
+#endif
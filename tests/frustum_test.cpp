@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "engine/math/aabb.hpp"
+#include "engine/math/frustum.hpp"
+#include "test.hpp"
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+using namespace Engine;
+
+static bool nearly_equal(glm::vec3 a, glm::vec3 b)
+{
+    auto difference = glm::abs(a - b);
+    return difference.x < 1e-4f && difference.y < 1e-4f && difference.z < 1e-4f;
+}
+
+TEST(aabb_extend)
+{
+    AABB box;
+    CHECK(box.is_empty());
+
+    box.extend(glm::vec3(1, 2, 3));
+    CHECK(!box.is_empty());
+    CHECK(nearly_equal(box.min, glm::vec3(1, 2, 3)));
+    CHECK(nearly_equal(box.max, glm::vec3(1, 2, 3)));
+
+    box.extend(AABB { glm::vec3(-1, 0, 0), glm::vec3(0, 4, 1) });
+    CHECK(nearly_equal(box.min, glm::vec3(-1, 0, 0)));
+    CHECK(nearly_equal(box.max, glm::vec3(1, 4, 3)));
+    CHECK(nearly_equal(box.center(), glm::vec3(0, 2, 1.5f)));
+    CHECK(nearly_equal(box.extent(), glm::vec3(1, 2, 1.5f)));
+}
+
+TEST(aabb_transformed)
+{
+    AABB box { glm::vec3(-1), glm::vec3(1) };
+    auto transform = glm::rotate(glm::translate(glm::mat4(1), glm::vec3(5, 0, 0)), glm::radians(45.0f), glm::vec3(0, 1, 0));
+    auto moved = box.transformed(transform);
+
+    auto half_diagonal = std::sqrt(2.0f);
+    CHECK(nearly_equal(moved.min, glm::vec3(5 - half_diagonal, -1, -half_diagonal)));
+    CHECK(nearly_equal(moved.max, glm::vec3(5 + half_diagonal, 1, half_diagonal)));
+}
+
+TEST(frustum_containment)
+{
+    auto projection = glm::perspective(glm::radians(70.0f), 1.5f, 0.1f, 1000.0f);
+    auto view = glm::lookAt(glm::vec3(0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+    auto frustum = Frustum::from(projection * view);
+
+    auto test = [&](glm::vec3 min, glm::vec3 max) {
+        return frustum.test(AABB { min, max });
+    };
+
+    CHECK(test(glm::vec3(-1, -1, -11), glm::vec3(1, 1, -9)) == Frustum::Containment::Inside);
+    CHECK(test(glm::vec3(-1, -1, 9), glm::vec3(1, 1, 11)) == Frustum::Containment::Outside);
+    CHECK(test(glm::vec3(-1, -1, -0.5f), glm::vec3(1, 1, 0.5f)) == Frustum::Containment::Intersects);
+    CHECK(test(glm::vec3(100, -1, -11), glm::vec3(102, 1, -9)) == Frustum::Containment::Outside);
+    CHECK(test(glm::vec3(-1, -1, -1100), glm::vec3(1, 1, -1050)) == Frustum::Containment::Outside);
+    CHECK(test(glm::vec3(-1, -1, -1010), glm::vec3(1, 1, -990)) == Frustum::Containment::Intersects);
+    CHECK(frustum.test(AABB {}) == Frustum::Containment::Outside);
+}
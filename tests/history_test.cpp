@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "gameobject/history.hpp"
+#include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <string>
+#include <vector>
+using namespace Object;
+
+TEST(history_rewind)
+{
+    World world;
+    History history(10);
+    history.track<Transform>();
+    world.add_listener(history);
+
+    auto& transform = world.add_child().add_component<Transform>();
+    transform.set_position(glm::vec3(1, 2, 3));
+    transform.set_rotation(glm::vec3(0, 1, 0));
+    history.capture();
+
+    auto forward = transform.forward();
+    auto orientation = transform.orientation();
+    for (int i = 0; i < 3; i++) {
+        transform.translate(glm::vec3(1, 0, 0));
+        transform.rotate(glm::vec3(0, 1, 0), 0.5f);
+        history.capture();
+    }
+
+    CHECK(history.size() == 4);
+    CHECK(!history.rewind(4));
+    CHECK(history.rewind(3));
+    CHECK(history.size() == 1);
+    CHECK(transform.position() == glm::vec3(1, 2, 3));
+    CHECK(transform.rotation() == glm::vec3(0, 1, 0));
+    CHECK(transform.forward() == forward);
+    CHECK(transform.orientation().w == orientation.w && transform.orientation().y == orientation.y);
+
+    // Frames no longer line up once a tracked component is added
+    world.add_child().add_component<Transform>();
+    CHECK(history.size() == 0);
+}
+
+TEST(history_cost)
+{
+    // About the transforms of a thousand bumper cars
+    constexpr int count = 17000;
+    World world;
+    History history(300);
+    history.track<Transform>();
+    world.add_listener(history);
+
+    std::vector<Transform*> transforms;
+    for (int i = 0; i < count; i++) {
+        auto& transform = world.add_child().add_component<Transform>();
+        transform.set_rotation(glm::vec3(0, i * 0.01f, 0));
+        transforms.push_back(&transform);
+    }
+
+    // Fill every frame first, so the timings don't include allocation
+    for (size_t i = 0; i < history.capacity(); i++) {
+        history.capture();
+    }
+
+    constexpr int ticks = 100;
+    Test::measure("Capture " + std::to_string(count) + " transforms", ticks, [&] {
+        for (int i = 0; i < ticks; i++) {
+            history.capture();
+        }
+    });
+
+    Test::measure("Rewind " + std::to_string(count) + " transforms", ticks, [&] {
+        for (int i = 0; i < ticks; i++) {
+            history.rewind(1);
+        }
+    });
+
+    CHECK(transforms.back()->rotation().y == (count - 1) * 0.01f);
+}
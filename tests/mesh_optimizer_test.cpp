@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "engine/graphics/mesh/mesh_builder.hpp"
+#include "engine/graphics/mesh/mesh_optimizer.hpp"
+#include "test.hpp"
+#include <cmath>
+using namespace Engine;
+
+// A grid of quads as a triangle soup, every triangle with its own vertices,
+// the way the Collada loader hands them over
+static MeshBuilder make_grid(int size)
+{
+    MeshBuilder builder;
+    uint32_t index = 0;
+    auto add_corner = [&](int x, int y) {
+        builder.add_vertex(glm::vec3(x, y, 0));
+        builder.add_normal(glm::vec3(0, 0, 1));
+        builder.add_uv0(glm::vec2(x, y) / float(size));
+        builder.add_indicies({ index++ });
+    };
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            add_corner(x, y);
+            add_corner(x + 1, y);
+            add_corner(x + 1, y + 1);
+            add_corner(x, y);
+            add_corner(x + 1, y + 1);
+            add_corner(x, y + 1);
+        }
+    }
+
+    return builder;
+}
+
+TEST(mesh_optimizer_cache_misses)
+{
+    // Everything after the first triangle is reused
+    CHECK(MeshOptimizer::cache_misses({ 0, 1, 2, 2, 1, 0, 0, 2, 1 }) == 3);
+
+    // Pushed out of a FIFO cache once enough others have come through
+    std::vector<uint32_t> indicies;
+    for (uint32_t i = 0; i < MeshOptimizer::cache_size + 1; i++) {
+        indicies.push_back(i);
+    }
+    indicies.push_back(0);
+    CHECK(MeshOptimizer::cache_misses(indicies) == MeshOptimizer::cache_size + 2);
+}
+
+TEST(mesh_optimizer_grid)
+{
+    constexpr int size = 40;
+    auto builder = make_grid(size);
+    auto bounds_before = builder.bounds();
+    auto uv_density_before = builder.uv_density();
+
+    auto stats = MeshOptimizer::optimize(builder);
+    CHECK(stats.triangles == size * size * 2);
+    CHECK(stats.vertices_before == size * size * 6);
+    CHECK(stats.vertices_after == (size + 1) * (size + 1));
+    CHECK(builder.vertex_count() == (size + 1) * (size + 1));
+
+    // Three misses a triangle with no sharing at all, a grid can reach one
+    // miss per triangle with a large enough cache
+    CHECK(stats.acmr_before() == 3.0f);
+    CHECK(stats.acmr_after() < 1.0f);
+
+    // Same surface afterwards
+    auto bounds_after = builder.bounds();
+    CHECK(bounds_after.min == bounds_before.min);
+    CHECK(bounds_after.max == bounds_before.max);
+    CHECK(std::abs(builder.uv_density() - uv_density_before) < 1e-4f);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "engine/graphics/mesh/mesh_builder.hpp"
+#include "engine/graphics/mesh/mesh_simplifier.hpp"
+#include "test.hpp"
+#include <cmath>
+#include <set>
+#include <tuple>
+using namespace Engine;
+
+// A gently rolling height field, welded, facing up the z axis
+static MeshBuilder make_terrain(int size)
+{
+    MeshBuilder builder;
+    for (int y = 0; y <= size; y++) {
+        for (int x = 0; x <= size; x++) {
+            auto height = 0.2f * std::sin(x * 0.7f) * std::cos(y * 0.5f);
+            builder.add_vertex(glm::vec3(x, y, height));
+            builder.add_normal(glm::vec3(0, 0, 1));
+            builder.add_uv0(glm::vec2(x, y) / float(size));
+        }
+    }
+
+    auto index = [&](int x, int y) { return static_cast<uint32_t>(y * (size + 1) + x); };
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            builder.add_indicies({ index(x, y), index(x + 1, y), index(x + 1, y + 1) });
+            builder.add_indicies({ index(x, y), index(x + 1, y + 1), index(x, y + 1) });
+        }
+    }
+
+    return builder;
+}
+
+static glm::vec3 corner(MeshBuilder const& builder, int triangle, int corner)
+{
+    return builder.vertex(static_cast<int>(builder.indicies()[triangle * 3 + corner]));
+}
+
+TEST(mesh_simplifier_terrain)
+{
+    constexpr int size = 40;
+    auto terrain = make_terrain(size);
+    CHECK(terrain.triangle_count() == size * size * 2);
+
+    for (int target : { 1600, 400, 300, 200 }) {
+        auto simplified = MeshSimplifier::simplify(terrain, target);
+
+        // Each collapse takes away two triangles, and nothing here should
+        // stop it getting there
+        CHECK(simplified.triangle_count() <= target);
+        CHECK(simplified.triangle_count() + 2 >= target);
+
+        // Nothing's turned inside out
+        for (int triangle = 0; triangle < simplified.triangle_count(); triangle++) {
+            auto a = corner(simplified, triangle, 0);
+            auto b = corner(simplified, triangle, 1);
+            auto c = corner(simplified, triangle, 2);
+            CHECK(glm::cross(b - a, c - a).z > 0);
+        }
+
+        // Every border vertex is still used, exactly where it was
+        std::set<std::tuple<float, float, float>> used;
+        for (auto index : simplified.indicies()) {
+            auto position = simplified.vertex(static_cast<int>(index));
+            used.insert({ position.x, position.y, position.z });
+        }
+
+        for (int vertex = 0; vertex < terrain.vertex_count(); vertex++) {
+            auto position = terrain.vertex(vertex);
+            auto is_border = position.x == 0 || position.y == 0 || position.x == size || position.y == size;
+            if (is_border) {
+                CHECK(used.contains({ position.x, position.y, position.z }));
+            }
+        }
+    }
+}
+
+TEST(mesh_simplifier_lods)
+{
+    auto terrain = make_terrain(40);
+    auto levels = MeshSimplifier::build_lods(terrain, 4);
+    CHECK(levels.size() == 4);
+    for (size_t level = 1; level < levels.size(); level++) {
+        CHECK(levels[level].triangle_count() <= levels[level - 1].triangle_count() / 2);
+    }
+
+    Test::measure("Simplify 3200 triangles to 400", 1, [&] {
+        MeshSimplifier::simplify(terrain, 400);
+    });
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "engine/physics/collision_shape_2d.hpp"
+#include "gameobject/attributes.hpp"
+#include "gameobject/mesh_render.hpp"
+#include "gameobject/physics/box_bounds_3d.hpp"
+#include "gameobject/physics/collider_2d.hpp"
+#include "gameobject/physics/physics_body_2d.hpp"
+#include "gameobject/prefab.hpp"
+#include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <utility>
+using namespace Object;
+
+// Shaped like a bumper car: a physics body with a few colliders, and a
+// part for each mesh in the model. Meshes are never drawn here, so there
+// aren't any.
+static GameObject& make_car(GameObject& parent)
+{
+    auto& car = parent.add_child();
+    car.add_component<Transform>();
+    car.add_component<PhysicsBody2D>(glm::vec2(6, 4), 1.0f, 1.0f, 0.2f);
+    car.add_component<Collider2D>(std::make_shared<Engine::CollisionShapeCircle2D>(glm::vec2(0, 1), 1.0f));
+    car.add_component<Collider2D>(std::make_shared<Engine::CollisionShapeOBB2D>(glm::vec2(0), glm::vec2(1, 2)));
+    car.add_component<Collider2D>(std::make_shared<Engine::CollisionShapeCircle2D>(glm::vec2(0, -1), 1.0f));
+    car.add_component<BoxBounds3D>(std::vector<BoxBounds3D::Box>(8));
+
+    for (int i = 0; i < 16; i++) {
+        auto& part = car.add_child();
+        part.add_component<Transform>().set_position(glm::vec3(i, 0, 0));
+        part.add_component<MeshRender>(MeshRender::Lods(3), nullptr, Engine::Material { "Part" });
+        part.add_component<Attributes>("Part");
+    }
+
+    return car;
+}
+
+static std::vector<GameObject*> children(GameObject& object)
+{
+    std::vector<GameObject*> children;
+    object.for_each_child([&](GameObject& child) {
+        children.push_back(&child);
+        return IteratorDecision::Continue;
+    });
+
+    return children;
+}
+
+TEST(prefab_instances_share_data)
+{
+    World world;
+    auto& car = make_car(world);
+    auto prefab = Prefab::construct(car);
+    car.destroy();
+    world.flush_destroyed();
+
+    auto& a = prefab->instantiate(world);
+    auto& b = prefab->instantiate(world);
+    CHECK(children(a).size() == 16);
+
+    auto const& a_part = *children(a).front()->first<MeshRender>();
+    auto const& b_part = *children(b).front()->first<MeshRender>();
+    CHECK(&a_part.material() == &b_part.material());
+    CHECK(a_part.lod_count() == 3);
+
+    auto const& a_collider = *a.first<Collider2D>();
+    auto const& b_collider = *b.first<Collider2D>();
+    CHECK(&a_collider.shape() == &b_collider.shape());
+
+    // Transforms are per instance
+    a.first<Transform>()->set_position(glm::vec3(5, 0, 0));
+    CHECK(b.first<Transform>()->position() == glm::vec3(0));
+}
+
+TEST(prefab_spawn_cost)
+{
+    World world;
+    auto& car = make_car(world);
+    auto prefab = Prefab::construct(car);
+    car.destroy();
+    world.flush_destroyed();
+
+    // Once the pools are warm, as they will be after the first few spawns
+    constexpr int count = 200;
+    std::vector<GameObject*> cars;
+    auto spawn = [&] {
+        for (int i = 0; i < count; i++) {
+            cars.push_back(&prefab->instantiate(world));
+        }
+    };
+
+    spawn();
+    for (auto* spawned : cars) {
+        spawned->destroy();
+    }
+    cars.clear();
+    world.flush_destroyed();
+
+    Test::measure("Spawn a car of 17 objects", count, spawn);
+    world.update_transforms();
+    CHECK(children(world).size() == count);
+}
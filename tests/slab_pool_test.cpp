@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "gameobject/slab_pool.hpp"
+#include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <set>
+#include <vector>
+using namespace Object;
+
+TEST(slab_pool_alignment)
+{
+    // Pools are never destroyed, see SlabPool::for_each
+    auto& pool = *new SlabPool("test_alignment", 40, 32);
+    for (int i = 0; i < 1000; i++) {
+        auto address = reinterpret_cast<uintptr_t>(pool.allocate());
+        CHECK(address % 32 == 0);
+    }
+}
+
+TEST(slab_pool_reuses_freed_slots)
+{
+    auto& pool = *new SlabPool("test_reuse", 24, 8);
+
+    std::vector<void*> slots;
+    for (int i = 0; i < 2000; i++) {
+        slots.push_back(pool.allocate());
+    }
+    CHECK(std::set<void*>(slots.begin(), slots.end()).size() == slots.size());
+
+    auto slabs = pool.stats().slabs;
+    for (auto* slot : slots) {
+        pool.deallocate(slot);
+    }
+    CHECK(pool.stats().live_objects == 0);
+
+    // Everything fits back into the slabs already there
+    std::set<void*> freed(slots.begin(), slots.end());
+    for (int i = 0; i < 2000; i++) {
+        CHECK(freed.contains(pool.allocate()));
+    }
+
+    auto const& stats = pool.stats();
+    CHECK(stats.slabs == slabs);
+    CHECK(stats.live_objects == 2000);
+    CHECK(stats.peak_objects == 2000);
+    CHECK(stats.allocations == 4000);
+    CHECK(stats.frees == 2000);
+}
+
+TEST(slab_pool_spawn_despawn)
+{
+    constexpr int count = 1000;
+    constexpr int rounds = 20;
+
+    World world;
+    auto spawn_and_despawn = [&] {
+        std::vector<GameObject*> objects;
+        objects.reserve(count);
+        for (int i = 0; i < count; i++) {
+            auto& object = world.add_child();
+            object.add_component<Transform>();
+            objects.push_back(&object);
+        }
+
+        for (auto* object : objects) {
+            object->destroy();
+        }
+        world.flush_destroyed();
+    };
+
+    // The first round fills the pools, after that they should only reuse
+    spawn_and_despawn();
+    size_t slabs_after_first_round = 0;
+    SlabPool::for_each([&](SlabPool const& pool) { slabs_after_first_round += pool.stats().slabs; });
+
+    Test::measure("Spawn and despawn with a transform", count * rounds, [&] {
+        for (int i = 0; i < rounds; i++) {
+            spawn_and_despawn();
+        }
+    });
+
+    size_t slabs = 0;
+    size_t live_objects = 0;
+    SlabPool::for_each([&](SlabPool const& pool) {
+        slabs += pool.stats().slabs;
+        if (pool.name() == std::string_view("GameObject")) {
+            live_objects += pool.stats().live_objects;
+        }
+    });
+
+    CHECK(slabs == slabs_after_first_round);
+    CHECK(live_objects == 0);
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "gameobject/attributes.hpp"
+#include "gameobject/prefab.hpp"
+#include "gameobject/tag.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <string>
+#include <vector>
+using namespace Object;
+
+TEST(tags_tagged_under)
+{
+    World world;
+    auto& car = world.add_child();
+    auto& body = car.add_child();
+    body.add_component<Attributes>("Body");
+    auto& wheel = body.add_child();
+    wheel.add_component<Attributes>("Wheel", "Front");
+    auto& back_wheel = car.add_child();
+    back_wheel.add_component<Attributes>("Wheel");
+
+    auto& other_car = world.add_child();
+    other_car.add_child().add_component<Attributes>("Wheel");
+
+    // In the order they were tagged, and only below the given object
+    auto wheels = world.tagged(Tags::intern("Wheel"), car);
+    CHECK(wheels.size() == 2);
+    CHECK(wheels.size() == 2 && wheels[0] == &wheel && wheels[1] == &back_wheel);
+    CHECK(world.tagged(Tags::intern("Wheel"), world).size() == 3);
+    CHECK(world.tagged(Tags::intern("Body"), other_car).empty());
+
+    // Gone once destroyed
+    back_wheel.destroy();
+    world.flush_destroyed();
+    CHECK(world.tagged(Tags::intern("Wheel"), car).size() == 1);
+    CHECK(world.tagged(Tags::intern("Wheel"), world).size() == 2);
+
+    // Destroying a whole subtree takes everything below it out too
+    car.destroy();
+    world.flush_destroyed();
+    auto remaining = world.tagged(Tags::intern("Wheel"), world);
+    CHECK(remaining.size() == 1 && remaining[0]->is_descendant_of(other_car));
+    CHECK(world.tagged(Tags::intern("Body"), world).empty());
+
+    // New objects may reuse a destroyed one's memory, so mustn't inherit
+    // what was below it
+    for (int i = 0; i < 8; i++) {
+        CHECK(world.tagged(Tags::intern("Wheel"), world.add_child()).empty());
+    }
+}
+
+TEST(tags_tagged_prefab_instances)
+{
+    World world;
+    auto& car = world.add_child();
+    car.add_child().add_component<Attributes>("Wheel");
+    car.add_child().add_child().add_component<Attributes>("Wheel");
+    car.add_child().add_component<Attributes>("Cart");
+    auto prefab = Prefab::construct(car);
+    car.destroy();
+    world.flush_destroyed();
+
+    // Each instance only finds its own
+    auto wheel = Tags::intern("Wheel");
+    auto& first = prefab->instantiate(world);
+    auto& second = prefab->instantiate(world);
+    auto& third = prefab->instantiate(first);
+    CHECK(world.tagged(wheel, world).size() == 6);
+    CHECK(world.tagged(wheel, first).size() == 4);
+    CHECK(world.tagged(wheel, second).size() == 2);
+    CHECK(world.tagged(wheel, third).size() == 2);
+    for (auto* object : world.tagged(wheel, second)) {
+        CHECK(object->is_descendant_of(second));
+    }
+
+    third.destroy();
+    world.flush_destroyed();
+    CHECK(world.tagged(wheel, first).size() == 2);
+    CHECK(world.tagged(wheel, world).size() == 4);
+    CHECK(world.tagged(Tags::intern("Cart"), world).size() == 2);
+
+    first.destroy();
+    second.destroy();
+    world.flush_destroyed();
+    CHECK(world.tagged(wheel, world).empty());
+}
+
+TEST(tags_tagged_cost)
+{
+    World world;
+    auto& source = world.add_child();
+    for (int i = 0; i < 16; i++) {
+        auto& part = source.add_child();
+        part.add_component<Attributes>(i < 4 ? "Wheel" : "Part");
+    }
+    auto prefab = Prefab::construct(source);
+    source.destroy();
+    world.flush_destroyed();
+
+    std::vector<GameObject*> cars;
+    for (int i = 0; i < 500; i++) {
+        cars.push_back(&prefab->instantiate(world));
+    }
+
+    // What each car's init does, across every car
+    auto wheel = Tags::intern("Wheel");
+    size_t found = 0;
+    Test::measure("Find the wheels of 500 cars", 500, [&] {
+        for (auto* car : cars) {
+            found += world.tagged(wheel, *car).size();
+        }
+    });
+    CHECK(found == 500 * 4);
+}
+
+TEST(tags_out_of_tags)
+{
+    auto first = Tags::intern("tags_out_of_tags_0");
+    for (size_t i = 1; i <= MAX_TAGS; i++) {
+        Tags::intern("tags_out_of_tags_" + std::to_string(i));
+    }
+
+    // Tags handed out before carry on working
+    CHECK(first != UNTAGGED);
+    CHECK(Tags::intern("tags_out_of_tags_0") == first);
+
+    auto overflowed = Tags::intern("tags_out_of_tags_overflowed");
+    CHECK(overflowed == UNTAGGED);
+    CHECK(!Tags::find("tags_out_of_tags_overflowed"));
+    CHECK(Tags::name(overflowed).empty());
+
+    World world;
+    auto& object = world.add_child();
+    auto& attributes = object.add_component<Attributes>("tags_out_of_tags_0", "tags_out_of_tags_overflowed");
+    CHECK(attributes.has(first));
+    CHECK(!attributes.has(overflowed));
+    CHECK(!attributes.has("tags_out_of_tags_overflowed"));
+    CHECK(world.tagged(overflowed, world).empty());
+}
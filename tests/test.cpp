@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "test.hpp"
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct Entry {
+    std::string_view name;
+    Test::Function function;
+};
+
+// Registered during static initialisation, so can't be a plain global
+static std::vector<Entry>& tests()
+{
+    static std::vector<Entry> tests;
+    return tests;
+}
+
+static int s_failures = 0;
+
+Test::Registration::Registration(std::string_view name, Function function)
+{
+    tests().push_back(Entry { name, function });
+}
+
+void Test::fail(char const* file, int line, char const* expression)
+{
+    std::cerr << file << ":" << line << ": Check failed: " << expression << "\n";
+    s_failures += 1;
+}
+
+void Test::report(std::string_view what, double total_microseconds, int iterations)
+{
+    std::cout << "  " << what << ": " << total_microseconds / 1000.0 << "ms for " << iterations
+              << ", " << total_microseconds / iterations << "us each\n";
+}
+
+// Runs every test starting with the given prefix, or all of them
+int main(int argc, char** argv)
+{
+    auto prefix = std::string_view(argc > 1 ? argv[1] : "");
+
+    auto ran = 0;
+    for (auto const& [name, function] : tests()) {
+        if (!name.starts_with(prefix)) {
+            continue;
+        }
+
+        auto failures_before = s_failures;
+        std::cout << name << "\n";
+        function();
+        if (s_failures != failures_before) {
+            std::cout << "  FAILED\n";
+        }
+        ran += 1;
+    }
+
+    if (ran == 0) {
+        std::cerr << "Error: No tests match '" << prefix << "'\n";
+        return 1;
+    }
+
+    return s_failures == 0 ? 0 : 1;
+}
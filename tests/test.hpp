@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+// Just enough of a test harness to check the engine without pulling in a
+// framework. Each TEST registers itself, and the runner takes a prefix so
+// ctest can run one file's tests at a time.
+namespace Test {
+
+using Function = void (*)();
+
+struct Registration {
+    Registration(std::string_view name, Function);
+};
+
+void fail(char const* file, int line, char const* expression);
+void report(std::string_view what, double total_microseconds, int iterations);
+
+// Prints how long the body took per iteration, for the numbers quoted in
+// commit messages to be checked against
+template<typename Func>
+double measure(std::string_view what, int iterations, Func body)
+{
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    report(what, elapsed, iterations);
+    return elapsed / iterations;
+}
+
+}
+
+#define TEST(name)                                                        \
+    static void test_##name();                                            \
+    static Test::Registration s_test_registration_##name(#name, test_##name); \
+    static void test_##name()
+
+#define CHECK(expression)                                   \
+    do {                                                    \
+        if (!(expression)) {                                \
+            Test::fail(__FILE__, __LINE__, #expression);    \
+        }                                                   \
+    } while (false)
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2022, Ben Jilks <benjyjilks@gmail.com>
+ *
+ * SPDX-License-Identifier: BSD-2-Clause
+ */
+
+#include "gameobject/transform.hpp"
+#include "gameobject/world.hpp"
+#include "test.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+using namespace Object;
+
+// Walks up through every parent, without the hierarchy
+static glm::mat4 expected_global(GameObject const& object)
+{
+    auto transform = object.first<Transform>()->local_transform();
+    for (auto const* parent = object.parent(); parent; parent = parent->parent()) {
+        if (auto const* parent_transform = parent->first<Transform>()) {
+            transform = parent_transform->local_transform() * transform;
+        }
+    }
+
+    return transform;
+}
+
+static bool nearly_equal(glm::mat4 const& a, glm::mat4 const& b)
+{
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            if (std::abs(a[column][row] - b[column][row]) > 1e-3f) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void check_globals(std::vector<GameObject*> const& objects)
+{
+    auto mismatches = 0;
+    for (auto const* object : objects) {
+        auto const* transform = object->first<Transform>();
+        if (!nearly_equal(transform->global_transform(*object), expected_global(*object))) {
+            mismatches += 1;
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+static GameObject& spawn(GameObject& parent, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> angle(-3.0f, 3.0f);
+
+    auto& object = parent.add_child();
+    auto& transform = object.add_component<Transform>();
+    transform.set_position(glm::vec3(offset(random), offset(random), offset(random)));
+    transform.set_rotation(glm::vec3(0, angle(random), 0));
+    return object;
+}
+
+TEST(transform_hierarchy_spawn_move_destroy)
+{
+    std::mt19937 random(1234);
+    World world;
+
+    // Roots with a few levels below each, like cars and their parts
+    std::vector<GameObject*> objects;
+    for (int i = 0; i < 50; i++) {
+        auto& root = spawn(world, random);
+        objects.push_back(&root);
+        for (int j = 0; j < 4; j++) {
+            auto& child = spawn(root, random);
+            objects.push_back(&child);
+            objects.push_back(&spawn(child, random));
+        }
+    }
+
+    world.update_transforms();
+    check_globals(objects);
+
+    for (int round = 0; round < 200; round++) {
+        std::uniform_int_distribution<size_t> pick(0, objects.size() - 1);
+        auto* object = objects[pick(random)];
+
+        // Moved without an update in between, so read through the parents
+        object->first<Transform>()->translate(glm::vec3(1, 0, 0));
+        check_globals(objects);
+
+        // Spawned under something existing
+        auto& spawned = spawn(*objects[pick(random)], random);
+        objects.push_back(&spawned);
+        check_globals(objects);
+
+        // Destroyed along with everything below it
+        if (round % 3 == 0) {
+            auto* destroyed = objects[pick(random)];
+            destroyed->destroy();
+            world.flush_destroyed();
+            objects.clear();
+            world.for_each_child([&](GameObject& root) {
+                std::vector<GameObject*> stack = { &root };
+                while (!stack.empty()) {
+                    auto* next = stack.back();
+                    stack.pop_back();
+                    objects.push_back(next);
+                    next->for_each_child([&](GameObject& child) {
+                        stack.push_back(&child);
+                        return IteratorDecision::Continue;
+                    });
+                }
+                return IteratorDecision::Continue;
+            });
+        }
+
+        if (round % 7 == 0) {
+            world.update_transforms();
+        }
+        check_globals(objects);
+    }
+}
+
+TEST(transform_hierarchy_spawn_cost)
+{
+    // A spawn shouldn't cost more in a fuller world. The update once a
+    // frame is still a pass over every transform, though only a cheap one.
+    for (auto existing : { 1000, 20000 }) {
+        std::mt19937 random(1234);
+        World world;
+        for (int i = 0; i < existing; i++) {
+            spawn(world, random);
+        }
+        world.update_transforms();
+
+        constexpr int spawns = 200;
+        auto name = "Spawn among " + std::to_string(existing);
+        Test::measure(name, spawns, [&] {
+            for (int i = 0; i < spawns; i++) {
+                spawn(spawn(world, random), random);
+            }
+            world.update_transforms();
+        });
+
+        // One a frame, the worst case for rebuilding
+        Test::measure("Spawn a frame among " + std::to_string(existing), spawns, [&] {
+            for (int i = 0; i < spawns; i++) {
+                spawn(spawn(world, random), random);
+                world.update_transforms();
+            }
+        });
+    }
+}
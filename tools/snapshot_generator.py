@@ -0,0 +1,727 @@
+#!/usr/bin/env python
+
+import sys
+import os
+import heapq
+import math
+import struct
+import xml.etree.ElementTree as ElementTree
+from array import array
+from argparse import ArgumentParser
+from pathlib import Path
+from typing import BinaryIO, Optional
+
+# Must match Engine::ModelSnapshot
+MAGIC = 0x504e5342
+VERSION = 3
+
+# Baked for every mesh, loading takes as many of them as it asks for
+LOD_LEVELS = 4
+
+# Must match Engine::MeshOptimizer
+CACHE_SIZE = 16
+
+class Material:
+    def __init__(self):
+        self.color = (1.0, 1.0, 1.0)
+        self.specular_color = (0.0, 0.0, 0.0)
+        self.emission_color = (0.0, 0.0, 0.0)
+        self.normal_map_strength = 0.0
+        self.specular_focus = 32.0
+        self.metallic = 0.0
+        self.diffuse_map: Optional[str] = None
+        self.normal_map: Optional[str] = None
+        self.light_map: Optional[str] = None
+
+    def copy(self) -> 'Material':
+        material = Material()
+        material.__dict__.update(self.__dict__)
+        return material
+
+class Mesh:
+    def __init__(self):
+        self.vertices: list[float] = []
+        self.normals: list[float] = []
+        self.tangents: list[float] = []
+        self.bitangents: list[float] = []
+        self.uv01: list[float] = []
+        self.indices: list[int] = []
+
+    def vertex_count(self) -> int:
+        return len(self.vertices) // 3
+
+    # Name and components of each attribute, as MeshBuilder holds them
+    def streams(self) -> list[tuple[str, int]]:
+        return [('vertices', 3), ('normals', 3), ('uv01', 4), ('tangents', 3), ('bitangents', 3)]
+
+    # Rounded to what's stored, so welding compares what the engine would
+    def round_to_floats(self):
+        for name, _ in self.streams():
+            setattr(self, name, array('f', getattr(self, name)).tolist())
+
+def strip_namespaces(root: ElementTree.Element):
+    for element in root.iter():
+        if '}' in element.tag:
+            element.tag = element.tag.split('}', 1)[1]
+
+def parse_id_selector(selector: str) -> str:
+    return selector[1:]
+
+def load_float_array(node: Optional[ElementTree.Element]) -> list[float]:
+    if node is None or node.text is None:
+        return []
+    return [float(x) for x in node.text.split()]
+
+def load_int_array(node: Optional[ElementTree.Element]) -> list[int]:
+    if node is None or node.text is None:
+        return []
+    return [int(x) for x in node.text.split()]
+
+def vec_at_index(index: int, count: int, points: list[float]) -> list[float]:
+    return points[index * count:index * count + count]
+
+def load_sources(mesh_node: ElementTree.Element) -> dict[str, list[float]]:
+    sources = {}
+    for source_node in mesh_node.findall('source'):
+        sources[source_node.get('id')] = load_float_array(source_node.find('float_array'))
+
+    vertices_node = mesh_node.find('vertices')
+    if vertices_node is not None:
+        vertices_input_node = vertices_node.find('input')
+        sources[vertices_node.get('id')] = sources[parse_id_selector(vertices_input_node.get('source'))]
+    return sources
+
+def compute_tangents(mesh: Mesh, vertices: list[float], texture_coords: list[float], indices: list[int], index: int):
+    pos = [vec_at_index(indices[index + 3 * i], 3, vertices) for i in range(3)]
+    uv = [vec_at_index(indices[index + 3 * i + 2], 2, texture_coords) for i in range(3)]
+
+    edge0 = [pos[1][i] - pos[0][i] for i in range(3)]
+    edge1 = [pos[2][i] - pos[0][i] for i in range(3)]
+    delta_uv0 = [uv[1][i] - uv[0][i] for i in range(2)]
+    delta_uv1 = [uv[2][i] - uv[0][i] for i in range(2)]
+    determinant = delta_uv0[0] * delta_uv1[1] - delta_uv1[0] * delta_uv0[1]
+    f = 1.0 / determinant if determinant != 0 else math.inf
+
+    tangent = [(edge0[i] * delta_uv1[1] - edge1[i] * delta_uv0[1]) * f for i in range(3)]
+    bitangent = [(edge1[i] * delta_uv0[0] - edge0[i] * delta_uv1[0]) * f for i in range(3)]
+    mesh.tangents += tangent * 3
+    mesh.bitangents += bitangent * 3
+
+def load_mesh(mesh_node: ElementTree.Element) -> Mesh:
+    mesh = Mesh()
+    sources = load_sources(mesh_node)
+
+    vertices = normals = texture_coords_0 = texture_coords_1 = None
+    triangles_node = mesh_node.find('triangles')
+    for input_node in triangles_node.findall('input'):
+        semantic = input_node.get('semantic')
+        data_set = int(input_node.get('set', '0'))
+        source = sources[parse_id_selector(input_node.get('source'))]
+        if semantic == 'VERTEX':
+            vertices = source
+        elif semantic == 'NORMAL':
+            normals = source
+        elif semantic == 'TEXCOORD' and data_set == 0:
+            texture_coords_0 = source
+        elif semantic == 'TEXCOORD' and data_set == 1:
+            texture_coords_1 = source
+
+    indices = load_int_array(triangles_node.find('p'))
+    index_count = 0
+    for i in range(0, len(indices), 3 * 3):
+        for j in range(3):
+            index = i + j * 3
+            mesh.vertices += vec_at_index(indices[index + 0], 3, vertices)
+            mesh.normals += vec_at_index(indices[index + 1], 3, normals)
+
+            # UVs are flipped the same way as MeshBuilder::add_uv01
+            uv0 = vec_at_index(indices[index + 2], 2, texture_coords_0)
+            uv1 = vec_at_index(indices[index + 2], 2, texture_coords_1) if texture_coords_1 else [0.0, 1.0]
+            mesh.uv01 += [uv0[0], 1.0 - uv0[1], uv1[0], 1.0 - uv1[1]]
+
+        compute_tangents(mesh, vertices, texture_coords_0, indices, i)
+        mesh.indices += [index_count, index_count + 1, index_count + 2]
+        index_count += 3
+
+    mesh.round_to_floats()
+    return mesh
+
+# A port of Engine::MeshOptimizer, so snapshots hold meshes ready to draw
+
+def cache_misses(indices: list[int]) -> int:
+    cache: list[int] = []
+    misses = 0
+    for index in indices:
+        if index in cache:
+            continue
+
+        misses += 1
+        cache.append(index)
+        if len(cache) > CACHE_SIZE:
+            cache.pop(0)
+    return misses
+
+def weld(mesh: Mesh):
+    # Tangents are made per triangle, so aren't part of a vertex's
+    # identity. Welded vertices sum theirs, which smooths them.
+    keyed = [(name, count) for name, count in mesh.streams() if name not in ('tangents', 'bitangents')]
+    summed = [('tangents', 3), ('bitangents', 3)]
+
+    welded_indices: dict[tuple, int] = {}
+    remap = []
+    keyed_out: dict[str, list[float]] = { name: [] for name, _ in keyed }
+    summed_out: dict[str, list[float]] = { name: [] for name, _ in summed }
+    for vertex in range(mesh.vertex_count()):
+        key = tuple(value
+            for name, count in keyed
+            for value in getattr(mesh, name)[vertex * count:vertex * count + count])
+
+        welded = welded_indices.get(key)
+        if welded is None:
+            welded = len(welded_indices)
+            welded_indices[key] = welded
+            for name, count in keyed:
+                keyed_out[name] += getattr(mesh, name)[vertex * count:vertex * count + count]
+            for name, count in summed:
+                if getattr(mesh, name):
+                    summed_out[name] += [0.0] * count
+        remap.append(welded)
+
+        for name, count in summed:
+            values = getattr(mesh, name)
+            for component in range(count if values else 0):
+                summed_out[name][welded * count + component] += values[vertex * count + component]
+
+    for name, values in (keyed_out | summed_out).items():
+        setattr(mesh, name, values)
+    mesh.indices = [remap[index] for index in mesh.indices]
+
+def reorder_triangles(indices: list[int], vertex_count: int) -> list[int]:
+    # Tipsify, Sander et al. 2007. Fans out around one vertex at a time,
+    # then moves on to whichever neighbour is most likely still cached.
+    triangle_count = len(indices) // 3
+    adjacency: list[list[int]] = [[] for _ in range(vertex_count)]
+    for triangle in range(triangle_count):
+        for corner in range(3):
+            adjacency[indices[triangle * 3 + corner]].append(triangle)
+
+    live = [len(triangles) for triangles in adjacency]
+    cache_time = [0] * vertex_count
+    is_emitted = [False] * triangle_count
+    dead_end: list[int] = []
+    result: list[int] = []
+
+    time = CACHE_SIZE + 1
+    cursor = 0
+    fanning = 0 if vertex_count > 0 else -1
+    while fanning >= 0:
+        candidates = []
+        for triangle in adjacency[fanning]:
+            if is_emitted[triangle]:
+                continue
+
+            for vertex in indices[triangle * 3:triangle * 3 + 3]:
+                result.append(vertex)
+                dead_end.append(vertex)
+                candidates.append(vertex)
+                live[vertex] -= 1
+                if time - cache_time[vertex] > CACHE_SIZE:
+                    cache_time[vertex] = time
+                    time += 1
+            is_emitted[triangle] = True
+
+        # Prefer the candidate that's in the cache and will stay there
+        # while its own fan is emitted
+        best = -1
+        best_priority = -1
+        for vertex in candidates:
+            if live[vertex] == 0:
+                continue
+
+            priority = 0
+            if time - cache_time[vertex] + 2 * live[vertex] <= CACHE_SIZE:
+                priority = time - cache_time[vertex]
+            if priority > best_priority:
+                best = vertex
+                best_priority = priority
+
+        # Back track through recently used vertices, then fall back to
+        # scanning for anything left
+        while best < 0 and dead_end:
+            vertex = dead_end.pop()
+            if live[vertex] > 0:
+                best = vertex
+
+        while best < 0 and cursor < vertex_count:
+            if live[cursor] > 0:
+                best = cursor
+            cursor += 1
+
+        fanning = best
+
+    return result
+
+def reorder_vertices(mesh: Mesh):
+    # Number vertices in the order the triangles first use them. Any not
+    # used at all are dropped.
+    remap: dict[int, int] = {}
+    for index in mesh.indices:
+        if index not in remap:
+            remap[index] = len(remap)
+    order = list(remap.keys())
+
+    for name, count in mesh.streams():
+        values = getattr(mesh, name)
+        if values:
+            setattr(mesh, name, [value for vertex in order for value in values[vertex * count:vertex * count + count]])
+    mesh.indices = [remap[index] for index in mesh.indices]
+
+def optimize(mesh: Mesh) -> tuple[int, int, float, float]:
+    vertices_before = mesh.vertex_count()
+    triangles = max(len(mesh.indices) // 3, 1)
+    acmr_before = cache_misses(mesh.indices) / triangles
+
+    weld(mesh)
+    mesh.indices = reorder_triangles(mesh.indices, mesh.vertex_count())
+    reorder_vertices(mesh)
+    return vertices_before, mesh.vertex_count(), acmr_before, cache_misses(mesh.indices) / triangles
+
+# A port of Engine::MeshSimplifier, so LODs are built once when baking
+
+# How far a triangle's normal may turn in one collapse, about 75 degrees
+MIN_TURN_COSINE = 0.25
+
+def sub(a, b):
+    return (a[0] - b[0], a[1] - b[1], a[2] - b[2])
+
+def cross(a, b):
+    return (a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0])
+
+def dot(a, b) -> float:
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]
+
+# Symmetric 4x4 matrix, summing the squared distance to a set of planes
+def plane_quadric(normal, d: float, weight: float) -> list[float]:
+    a, b, c = normal
+    return [
+        weight * a * a, weight * a * b, weight * a * c, weight * a * d,
+        weight * b * b, weight * b * c, weight * b * d,
+        weight * c * c, weight * c * d,
+        weight * d * d,
+    ]
+
+def quadric_error(q: list[float], p) -> float:
+    x, y, z = p
+    return (q[0] * x * x + 2 * q[1] * x * y + 2 * q[2] * x * z + 2 * q[3] * x
+        + q[4] * y * y + 2 * q[5] * y * z + 2 * q[6] * y
+        + q[7] * z * z + 2 * q[8] * z
+        + q[9])
+
+def simplify(mesh: Mesh, target_triangles: int) -> Mesh:
+    # Group vertices sharing a position, the collapse works on these
+    position_ids: dict[tuple, int] = {}
+    position_of = []
+    positions = []
+    wedges: list[list[int]] = []
+    for vertex in range(mesh.vertex_count()):
+        position = tuple(mesh.vertices[vertex * 3:vertex * 3 + 3])
+        position_id = position_ids.setdefault(position, len(positions))
+        if position_id == len(positions):
+            positions.append(position)
+            wedges.append([])
+        position_of.append(position_id)
+        wedges[position_id].append(vertex)
+
+    triangles = list(mesh.indices)
+    triangle_count = len(triangles) // 3
+    is_triangle_removed = [False] * triangle_count
+    triangles_at: list[list[int]] = [[] for _ in positions]
+    quadrics = [[0.0] * 10 for _ in positions]
+    edge_uses: dict[tuple[int, int], int] = {}
+
+    def corners_of(triangle: int) -> list[int]:
+        return [position_of[index] for index in triangles[triangle * 3:triangle * 3 + 3]]
+
+    for triangle in range(triangle_count):
+        corners = corners_of(triangle)
+        if corners[0] == corners[1] or corners[1] == corners[2] or corners[0] == corners[2]:
+            is_triangle_removed[triangle] = True
+            continue
+
+        p0, p1, p2 = (positions[corner] for corner in corners)
+        normal = cross(sub(p1, p0), sub(p2, p0))
+        area = math.sqrt(dot(normal, normal))
+        if area > 0:
+            normal = (normal[0] / area, normal[1] / area, normal[2] / area)
+
+        # Weighted by area, so small triangles don't dominate
+        quadric = plane_quadric(normal, -dot(normal, p0), area)
+        for corner in range(3):
+            position = corners[corner]
+            quadrics[position] = [a + b for a, b in zip(quadrics[position], quadric)]
+            triangles_at[position].append(triangle)
+
+            a, b = position, corners[(corner + 1) % 3]
+            edge = (min(a, b), max(a, b))
+            edge_uses[edge] = edge_uses.get(edge, 0) + 1
+
+    # Moving a vertex on an open border would eat into the silhouette
+    is_locked = [False] * len(positions)
+    for (a, b), uses in edge_uses.items():
+        if uses == 1:
+            is_locked[a] = is_locked[b] = True
+
+    versions = [0] * len(positions)
+    is_removed = [False] * len(positions)
+    queue: list[tuple[float, int, int, int, int]] = []
+
+    def push(from_: int, to: int):
+        if is_locked[from_]:
+            return
+        quadric = [a + b for a, b in zip(quadrics[from_], quadrics[to])]
+        heapq.heappush(queue, (quadric_error(quadric, positions[to]), from_, to, versions[from_], versions[to]))
+
+    for a, b in sorted(edge_uses):
+        push(a, b)
+        push(b, a)
+
+    # Collapsing mustn't turn any remaining triangle around from over, or
+    # fold it up on edge
+    def would_flip(from_: int, to: int) -> bool:
+        for triangle in triangles_at[from_]:
+            if is_triangle_removed[triangle]:
+                continue
+
+            corners = corners_of(triangle)
+            if to in corners:
+                continue
+
+            before = [positions[corner] for corner in corners]
+            after = [positions[to] if corner == from_ else positions[corner] for corner in corners]
+            normal_before = cross(sub(before[1], before[0]), sub(before[2], before[0]))
+            normal_after = cross(sub(after[1], after[0]), sub(after[2], after[0]))
+            length_before = math.sqrt(dot(normal_before, normal_before))
+            length_after = math.sqrt(dot(normal_after, normal_after))
+            if length_before == 0:
+                continue
+            if length_after == 0 or dot(normal_before, normal_after) <= MIN_TURN_COSINE * length_before * length_after:
+                return True
+        return False
+
+    # The wedge at the new position most like the one being replaced, so
+    # normals and UVs stay as close as they can across seams
+    def closest_wedge(vertex: int, to: int) -> int:
+        best = wedges[to][0]
+        best_distance = math.inf
+        for candidate in wedges[to]:
+            distance = 0.0
+            for values, count in ((mesh.normals, 3), (mesh.uv01, 4)):
+                for i in range(count if values else 0):
+                    delta = values[vertex * count + i] - values[candidate * count + i]
+                    distance += delta * delta
+            if distance < best_distance:
+                best = candidate
+                best_distance = distance
+        return best
+
+    live_triangles = is_triangle_removed.count(False)
+    while live_triangles > target_triangles and queue:
+        _, from_, to, from_version, to_version = heapq.heappop(queue)
+        if is_removed[from_] or is_removed[to]:
+            continue
+        if from_version != versions[from_] or to_version != versions[to]:
+            continue
+        if would_flip(from_, to):
+            continue
+
+        for triangle in triangles_at[from_]:
+            if is_triangle_removed[triangle]:
+                continue
+            if to in corners_of(triangle):
+                is_triangle_removed[triangle] = True
+                live_triangles -= 1
+                continue
+
+            for corner in range(triangle * 3, triangle * 3 + 3):
+                if position_of[triangles[corner]] == from_:
+                    triangles[corner] = closest_wedge(triangles[corner], to)
+            triangles_at[to].append(triangle)
+
+        quadrics[to] = [a + b for a, b in zip(quadrics[to], quadrics[from_])]
+        is_removed[from_] = True
+        versions[to] += 1
+
+        # Only the merged vertex's quadric changed, so only the edges
+        # touching it need costing again
+        for triangle in triangles_at[to]:
+            if is_triangle_removed[triangle]:
+                continue
+            for neighbour in corners_of(triangle):
+                if neighbour != to:
+                    push(neighbour, to)
+                    push(to, neighbour)
+
+    # Keep every attribute, unused vertices are dropped by the optimiser
+    simplified = Mesh()
+    for name, _ in mesh.streams():
+        setattr(simplified, name, list(getattr(mesh, name)))
+    simplified.indices = [index
+        for triangle in range(triangle_count) if not is_triangle_removed[triangle]
+        for index in triangles[triangle * 3:triangle * 3 + 3]]
+
+    optimize(simplified)
+    return simplified
+
+# Level 0 is the mesh as given, each level after has at most ratio times
+# the triangles of the one before. Stops early if a level can't be
+# reduced much further.
+def build_lods(mesh: Mesh, level_count: int, ratio: float = 0.5) -> list[Mesh]:
+    levels = [mesh]
+    while len(levels) < level_count:
+        previous_triangles = len(levels[-1].indices) // 3
+        level = simplify(levels[-1], int(previous_triangles * ratio))
+
+        # Not worth a level of its own if barely any simpler
+        if len(level.indices) // 3 > previous_triangles * 0.9:
+            break
+        levels.append(level)
+    return levels
+
+def load_color(node: ElementTree.Element) -> tuple[float, float, float]:
+    values = load_float_array(node)
+    return (values[0], values[1], values[2])
+
+def load_textures(image_library: dict[str, str], profile_node: ElementTree.Element) -> dict[str, str]:
+    textures = {}
+    for param_node in profile_node.findall('newparam'):
+        sid = param_node.get('sid')
+        surface_node = param_node.find('surface')
+        sampler_node = param_node.find('sampler2D')
+        if surface_node is not None:
+            image_id = surface_node.findtext('init_from', '')
+            if image_id not in image_library:
+                print(f'Warning: Image \'{ image_id }\', not found')
+                continue
+            textures[sid] = image_library[image_id]
+        elif sampler_node is not None:
+            texture_id = sampler_node.findtext('source', '')
+            if texture_id not in textures:
+                print(f'Warning: Texture \'{ texture_id }\', not found')
+                continue
+            textures[sid] = textures[texture_id]
+    return textures
+
+def load_lambert(material: Material, texture_library: dict[str, str], lambert_node: ElementTree.Element):
+    diffuse_node = lambert_node.find('diffuse')
+    if diffuse_node is not None and diffuse_node.find('texture') is not None:
+        texture_id = diffuse_node.find('texture').get('texture')
+        material.diffuse_map = texture_library.get(texture_id)
+    elif diffuse_node is not None and diffuse_node.find('color') is not None:
+        material.diffuse_map = '/textures/bumper/white.jpg'
+        material.color = load_color(diffuse_node.find('color'))
+
+    emission_node = lambert_node.find('emission')
+    if emission_node is not None:
+        material.emission_color = load_color(emission_node.find('color'))
+
+    specular_node = lambert_node.find('specular')
+    if specular_node is not None:
+        material.specular_color = load_color(specular_node.find('color'))
+        if specular_node.find('float') is not None:
+            material.specular_focus = float(specular_node.findtext('float'))
+
+    reflectivity_node = lambert_node.find('reflectivity')
+    if reflectivity_node is not None:
+        reflectivity = float(reflectivity_node.findtext('float'))
+        material.specular_color = (reflectivity, reflectivity, reflectivity)
+
+    metallic_node = lambert_node.find('metallic')
+    if metallic_node is not None:
+        material.metallic = float(metallic_node.findtext('float'))
+
+def load_extra(material: Material, texture_library: dict[str, str], extra_node: ElementTree.Element):
+    technique_node = extra_node.find('technique')
+    bump_node = technique_node.find('bump')
+    if bump_node is not None:
+        material.normal_map = texture_library.get(bump_node.find('texture').get('texture'))
+        if bump_node.find('float') is not None:
+            material.normal_map_strength = float(bump_node.findtext('float'))
+
+    lightmap_node = technique_node.find('lightmap')
+    if lightmap_node is not None:
+        material.light_map = texture_library.get(lightmap_node.find('texture').get('texture'))
+
+def load_effects(image_library: dict[str, str], effects_node: ElementTree.Element) -> dict[str, Material]:
+    effects = {}
+    for effect_node in effects_node.findall('effect'):
+        profile_node = effect_node.find('profile_COMMON')
+        texture_library = load_textures(image_library, profile_node)
+
+        material = Material()
+        technique_node = profile_node.find('technique')
+        if technique_node.find('lambert') is not None:
+            load_lambert(material, texture_library, technique_node.find('lambert'))
+        if technique_node.find('extra') is not None:
+            load_extra(material, texture_library, technique_node.find('extra'))
+        effects[effect_node.get('id')] = material
+    return effects
+
+def load_rotation(node_node: ElementTree.Element) -> tuple[float, float, float]:
+    rotation = [0.0, 0.0, 0.0]
+    for rotate_node in node_node.findall('rotate'):
+        x, y, z, angle = load_float_array(rotate_node)
+        for i, axis in enumerate((x, y, z)):
+            rotation[i] += axis * math.radians(angle)
+    return (rotation[0], rotation[1], rotation[2])
+
+def write_u32(out: BinaryIO, value: int):
+    out.write(struct.pack('<I', value))
+
+def write_string(out: BinaryIO, string: str):
+    data = string.encode('UTF-8')
+    write_u32(out, len(data))
+    out.write(data)
+
+def write_floats(out: BinaryIO, values):
+    out.write(struct.pack(f'<{ len(values) }f', *values))
+
+def write_array(out: BinaryIO, values: list, format: str):
+    write_u32(out, len(values))
+    out.write(struct.pack(f'<{ len(values) }{ format }', *values))
+
+def generate_snapshot(model_path: Path, snapshot_path: Path):
+    root = ElementTree.parse(model_path).getroot()
+    strip_namespaces(root)
+
+    image_library = {}
+    for image_node in root.find('library_images').findall('image'):
+        image_library[image_node.get('id')] = image_node.findtext('init_from', '')
+
+    effect_library = load_effects(image_library, root.find('library_effects'))
+    material_library = {}
+    for material_node in root.find('library_materials').findall('material'):
+        effect_id = parse_id_selector(material_node.find('instance_effect').get('url'))
+        material_library[material_node.get('id')] = effect_library[effect_id]
+
+    mesh_library = {}
+    for geometry_node in root.find('library_geometries').findall('geometry'):
+        mesh_library[geometry_node.get('id')] = load_mesh(geometry_node.find('mesh'))
+
+    # Only keep what the visual scenes actually reference
+    textures: list[str] = []
+    materials: list[str] = []
+    meshes: list[str] = []
+    nodes = []
+    for visual_scene_node in root.find('library_visual_scenes').findall('visual_scene'):
+        for node_node in visual_scene_node.findall('node'):
+            instance_geometry_node = node_node.find('instance_geometry')
+            mesh_id = parse_id_selector(instance_geometry_node.get('url'))
+            material_id = parse_id_selector(instance_geometry_node
+                .find('bind_material')
+                .find('technique_common')
+                .find('instance_material')
+                .get('target'))
+
+            if mesh_id not in meshes:
+                meshes.append(mesh_id)
+            if material_id not in materials:
+                materials.append(material_id)
+            nodes.append((node_node, meshes.index(mesh_id), materials.index(material_id)))
+
+    for material_id in materials:
+        material = material_library[material_id]
+        for texture in (material.diffuse_map, material.normal_map, material.light_map):
+            if texture is not None and texture not in textures:
+                textures.append(texture)
+
+    # Welded and reordered here, so loading a snapshot has nothing left to
+    # do to its meshes
+    vertices_before = vertices_after = cache_misses_before = cache_misses_after = triangles = 0
+    for mesh_id in meshes:
+        mesh = mesh_library[mesh_id]
+        mesh_vertices_before, mesh_vertices_after, acmr_before, acmr_after = optimize(mesh)
+        mesh_triangles = len(mesh.indices) // 3
+        vertices_before += mesh_vertices_before
+        vertices_after += mesh_vertices_after
+        cache_misses_before += acmr_before * mesh_triangles
+        cache_misses_after += acmr_after * mesh_triangles
+        triangles += mesh_triangles
+
+    triangles = max(triangles, 1)
+    print(f'    { vertices_before } -> { vertices_after } vertices, '
+        f'ACMR { cache_misses_before / triangles:.3f} -> { cache_misses_after / triangles:.3f}')
+
+    mesh_levels = { mesh_id: build_lods(mesh_library[mesh_id], LOD_LEVELS) for mesh_id in meshes }
+
+    def texture_index(texture: Optional[str]) -> int:
+        return textures.index(texture) if texture is not None else -1
+
+    os.makedirs(snapshot_path.parent, exist_ok=True)
+    with open(snapshot_path, 'wb') as out:
+        write_u32(out, MAGIC)
+        write_u32(out, VERSION)
+
+        write_u32(out, len(textures))
+        for texture in textures:
+            write_string(out, texture)
+
+        write_u32(out, len(materials))
+        for material_id in materials:
+            material = material_library[material_id]
+            write_string(out, '')
+            write_floats(out, material.color)
+            write_floats(out, material.specular_color)
+            write_floats(out, material.emission_color)
+            write_floats(out, (material.normal_map_strength, material.specular_focus, material.metallic))
+            out.write(struct.pack('<3i',
+                texture_index(material.diffuse_map),
+                texture_index(material.normal_map),
+                texture_index(material.light_map)))
+
+        write_u32(out, len(meshes))
+        for mesh_id in meshes:
+            write_u32(out, len(mesh_levels[mesh_id]))
+            for mesh in mesh_levels[mesh_id]:
+                write_array(out, mesh.vertices, 'f')
+                write_array(out, mesh.normals, 'f')
+                write_array(out, mesh.tangents, 'f')
+                write_array(out, mesh.bitangents, 'f')
+                write_array(out, mesh.uv01, 'f')
+                write_array(out, mesh.indices, 'I')
+
+        write_u32(out, len(nodes))
+        for node_node, mesh_index, material_index in nodes:
+            write_string(out, node_node.get('name', ''))
+            write_u32(out, mesh_index)
+            write_u32(out, material_index)
+            write_floats(out, load_float_array(node_node.find('translate'))[:3] or (0.0, 0.0, 0.0))
+            write_floats(out, load_float_array(node_node.find('scale'))[:3] or (1.0, 1.0, 1.0))
+            write_floats(out, load_rotation(node_node))
+
+def snapshot_name(model: str) -> str:
+    return str(Path(model).with_suffix('.snapshot'))
+
+def main():
+    parser = ArgumentParser(description='Bake Collada models into binary snapshots')
+    parser.add_argument('--output-dir', type=str, required=True, help='Directory to write snapshots into')
+    parser.add_argument('--asset-dir', type=str, required=True, help='Directory containing the models')
+    parser.add_argument('models', type=str, nargs='*', help='List of models to bake')
+    options = parser.parse_args(sys.argv[1:])
+    output_dir = Path(options.output_dir)
+    asset_dir = Path(options.asset_dir)
+
+    # A change to the generator may change the format, so rebake then too
+    generator_mtime = Path(__file__).stat().st_mtime
+
+    for model in options.models:
+        model_path = asset_dir.joinpath(model)
+        snapshot_path = output_dir.joinpath(snapshot_name(model))
+        source_mtime = max(model_path.stat().st_mtime, generator_mtime)
+        if snapshot_path.exists() and snapshot_path.stat().st_mtime >= source_mtime:
+            continue
+
+        print(f' -> { snapshot_name(model) }')
+        generate_snapshot(model_path, snapshot_path)
+
+if __name__ == '__main__':
+    main()
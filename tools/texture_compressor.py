@@ -0,0 +1,328 @@
+#!/usr/bin/env python
+
+import sys
+import os
+import struct
+from argparse import ArgumentParser
+from pathlib import Path
+
+try:
+    import numpy as np
+    from PIL import Image
+except ImportError as error:
+    print(f'Error: Texture compression needs Pillow and NumPy ({ error })')
+    sys.exit(1)
+
+# Must match Engine::CompressedImage
+KTX_IDENTIFIER = bytes([0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A])
+KTX_ENDIANNESS = 0x04030201
+
+GL_RGB = 0x1907
+GL_RGBA = 0x1908
+GL_RG = 0x8227
+GL_COMPRESSED_RGB_S3TC_DXT1_EXT = 0x83F0
+GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3
+GL_COMPRESSED_RG_RGTC2 = 0x8DBD
+GL_COMPRESSED_RG11_EAC = 0x9272
+GL_COMPRESSED_RGB8_ETC2 = 0x9274
+GL_COMPRESSED_RGBA8_ETC2_EAC = 0x9278
+
+# Blocks are encoded this many at a time, to bound memory use
+CHUNK_SIZE = 4096
+
+ETC_MODIFIERS = np.array([
+    [2, 8], [5, 17], [9, 29], [13, 42],
+    [18, 60], [24, 80], [33, 106], [47, 183],
+], dtype=np.float32)
+
+EAC_MODIFIERS = np.array([
+    [-3, -6, -9, -15, 2, 5, 8, 14],
+    [-3, -7, -10, -13, 2, 6, 9, 12],
+    [-2, -5, -8, -13, 1, 4, 7, 12],
+    [-2, -4, -6, -13, 1, 3, 5, 12],
+    [-3, -6, -8, -12, 2, 5, 7, 11],
+    [-3, -7, -9, -11, 2, 6, 8, 10],
+    [-4, -7, -8, -11, 3, 6, 7, 10],
+    [-3, -5, -8, -11, 2, 4, 7, 10],
+    [-2, -6, -8, -10, 1, 5, 7, 9],
+    [-2, -5, -8, -10, 1, 4, 7, 9],
+    [-2, -4, -8, -10, 1, 3, 7, 9],
+    [-2, -5, -7, -10, 1, 4, 6, 9],
+    [-3, -4, -7, -10, 2, 3, 6, 9],
+    [-1, -2, -3, -10, 0, 1, 2, 9],
+    [-4, -6, -8, -9, 3, 5, 7, 8],
+    [-3, -5, -7, -9, 2, 4, 6, 8],
+], dtype=np.float32)
+
+def is_normal_map(image: str) -> bool:
+    # Every normal map in the assets is named as such
+    return 'normal' in Path(image).name.lower()
+
+def to_blocks(pixels: np.ndarray) -> np.ndarray:
+    """Splits an image into 4x4 blocks of 16 pixels, in row major order"""
+    height, width, channels = pixels.shape
+    padded = np.pad(pixels, ((0, -height % 4), (0, -width % 4), (0, 0)), mode='edge')
+    block_rows, block_columns = padded.shape[0] // 4, padded.shape[1] // 4
+    blocks = padded.reshape(block_rows, 4, block_columns, 4, channels).transpose(0, 2, 1, 3, 4)
+    return blocks.reshape(-1, 16, channels).astype(np.float32)
+
+def column_major(blocks: np.ndarray) -> np.ndarray:
+    """ETC numbers pixels down each column, rather than along each row"""
+    return blocks.reshape(-1, 4, 4, blocks.shape[-1]).transpose(0, 2, 1, 3).reshape(blocks.shape)
+
+def pack_indices(indices: np.ndarray, bits: int, most_significant_first: bool = False) -> np.ndarray:
+    count = indices.shape[1]
+    shifts = np.arange(count, dtype=np.uint64) * bits
+    if most_significant_first:
+        shifts = shifts[::-1]
+    return np.bitwise_or.reduce(indices.astype(np.uint64) << shifts, axis=1)
+
+def expand_565(color: np.ndarray) -> np.ndarray:
+    r, g, b = (color >> 11) & 31, (color >> 5) & 63, color & 31
+    return np.stack([(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)], axis=-1).astype(np.float32)
+
+def encode_bc1(blocks: np.ndarray) -> np.ndarray:
+    colors = blocks[:, :, :3]
+
+    # End points are the extremes along the colours' principal axis
+    mean = colors.mean(axis=1, keepdims=True)
+    centered = colors - mean
+    covariance = np.einsum('nki,nkj->nij', centered, centered)
+    axis = colors.max(axis=1) - colors.min(axis=1) + 1e-3
+    for _ in range(8):
+        axis = np.einsum('nij,nj->ni', covariance, axis)
+        axis /= np.linalg.norm(axis, axis=1, keepdims=True) + 1e-12
+    projection = np.einsum('nki,ni->nk', centered, axis)
+    low = np.clip(mean[:, 0] + axis * projection.min(axis=1, keepdims=True), 0, 255)
+    high = np.clip(mean[:, 0] + axis * projection.max(axis=1, keepdims=True), 0, 255)
+
+    def quantize(color: np.ndarray) -> np.ndarray:
+        r = np.round(color[:, 0] * 31 / 255).astype(np.uint32)
+        g = np.round(color[:, 1] * 63 / 255).astype(np.uint32)
+        b = np.round(color[:, 2] * 31 / 255).astype(np.uint32)
+        return (r << 11) | (g << 5) | b
+
+    # The first end point must be larger to select the four colour mode
+    color0, color1 = quantize(high), quantize(low)
+    color0, color1 = np.maximum(color0, color1), np.minimum(color0, color1)
+
+    end0, end1 = expand_565(color0), expand_565(color1)
+    palette = np.stack([end0, end1, (2 * end0 + end1) / 3, (end0 + 2 * end1) / 3], axis=1)
+    errors = ((colors[:, :, None, :] - palette[:, None, :, :]) ** 2).sum(axis=-1)
+    indices = errors.argmin(axis=-1)
+    indices[color0 == color1] = 0
+
+    out = np.zeros((len(blocks), 8), dtype=np.uint8)
+    out[:, 0:2] = color0.astype('<u2').view(np.uint8).reshape(-1, 2)
+    out[:, 2:4] = color1.astype('<u2').view(np.uint8).reshape(-1, 2)
+    out[:, 4:8] = pack_indices(indices, 2).astype('<u4').view(np.uint8).reshape(-1, 4)
+    return out
+
+def encode_bc4(values: np.ndarray) -> np.ndarray:
+    high = np.round(values.max(axis=1))
+    low = np.round(values.min(axis=1))
+
+    # The first end point being larger selects eight interpolated values
+    weights = np.array([0, 7, 1, 2, 3, 4, 5, 6], dtype=np.float32) / 7
+    palette = high[:, None] * (1 - weights) + low[:, None] * weights
+    indices = np.abs(values[:, :, None] - palette[:, None, :]).argmin(axis=-1)
+    indices[high == low] = 0
+
+    out = np.zeros((len(values), 8), dtype=np.uint8)
+    out[:, 0] = high
+    out[:, 1] = low
+    out[:, 2:8] = pack_indices(indices, 3).astype('<u8').view(np.uint8).reshape(-1, 8)[:, :6]
+    return out
+
+def encode_bc3(blocks: np.ndarray) -> np.ndarray:
+    return np.concatenate([encode_bc4(blocks[:, :, 3]), encode_bc1(blocks)], axis=1)
+
+def encode_bc5(blocks: np.ndarray) -> np.ndarray:
+    return np.concatenate([encode_bc4(blocks[:, :, 0]), encode_bc4(blocks[:, :, 1])], axis=1)
+
+def etc_sub_block_masks() -> np.ndarray:
+    """For each flip, which of the column major pixels are in the first sub block"""
+    pixels = np.arange(16)
+    return np.stack([pixels < 8, pixels % 4 < 2])
+
+def etc_fit_table(pixels: np.ndarray, base: np.ndarray) -> tuple[np.ndarray, np.ndarray, np.ndarray]:
+    """Best modifier table for each sub block, with its error and per pixel selectors"""
+    # Selectors 0 to 3 are small positive, large positive, small negative, large negative
+    modifiers = np.concatenate([ETC_MODIFIERS, -ETC_MODIFIERS], axis=1)
+    decoded = np.clip(base[:, None, None, :] + modifiers[None, :, :, None], 0, 255)
+    errors = ((pixels[:, :, None, None, :] - decoded[:, None, :, :, :]) ** 2).sum(axis=-1)
+    selectors = errors.argmin(axis=-1)
+    table_errors = errors.min(axis=-1).sum(axis=1)
+    tables = table_errors.argmin(axis=-1)
+    rows = np.arange(len(pixels))
+    return tables, table_errors[rows, tables], selectors[rows, :, tables]
+
+def encode_etc2(blocks: np.ndarray) -> np.ndarray:
+    pixels = column_major(blocks[:, :, :3])
+    count = len(pixels)
+
+    best_error = np.full(count, np.inf)
+    best_bits = np.zeros(count, dtype=np.uint64)
+    for flip, mask in enumerate(etc_sub_block_masks()):
+        sub_blocks = [pixels[:, mask], pixels[:, ~mask]]
+        averages = [sub_block.mean(axis=1) for sub_block in sub_blocks]
+
+        # Differential mode keeps more precision, if the two bases are close
+        # enough. Bases that fall outside it would select the ETC2 only modes.
+        fine = [np.round(average * 31 / 255).astype(np.int64) for average in averages]
+        delta = fine[1] - fine[0]
+        is_differential = np.all((delta >= -4) & (delta <= 3), axis=1)
+        coarse = [np.round(average * 15 / 255).astype(np.int64) for average in averages]
+
+        bases = []
+        for sub_block in range(2):
+            fine_base = (fine[sub_block] << 3) | (fine[sub_block] >> 2)
+            coarse_base = coarse[sub_block] * 17
+            bases.append(np.where(is_differential[:, None], fine_base, coarse_base).astype(np.float32))
+
+        tables, errors, selectors = [], np.zeros(count), []
+        for sub_block in range(2):
+            table, error, selector = etc_fit_table(sub_blocks[sub_block], bases[sub_block])
+            tables.append(table)
+            selectors.append(selector)
+            errors += error
+
+        # Each selector is split into a most and least significant bit plane
+        codes = np.zeros((count, 16), dtype=np.uint64)
+        codes[:, mask] = selectors[0]
+        codes[:, ~mask] = selectors[1]
+        least = np.bitwise_or.reduce((codes & 1) << np.arange(16, dtype=np.uint64), axis=1)
+        most = np.bitwise_or.reduce((codes >> 1) << np.arange(16, dtype=np.uint64), axis=1)
+
+        colors = np.zeros(count, dtype=np.uint64)
+        for channel in range(3):
+            shift = np.uint64(56 - channel * 8)
+            differential = (fine[0][:, channel] << 3) | (delta[:, channel] & 7)
+            individual = (coarse[0][:, channel] << 4) | coarse[1][:, channel]
+            colors |= np.where(is_differential, differential, individual).astype(np.uint64) << shift
+
+        bits = (colors
+            | (tables[0].astype(np.uint64) << np.uint64(37))
+            | (tables[1].astype(np.uint64) << np.uint64(34))
+            | (is_differential.astype(np.uint64) << np.uint64(33))
+            | (np.uint64(flip) << np.uint64(32))
+            | (most << np.uint64(16))
+            | least)
+
+        is_better = errors < best_error
+        best_error = np.where(is_better, errors, best_error)
+        best_bits = np.where(is_better, bits, best_bits)
+
+    return best_bits.astype('>u8').view(np.uint8).reshape(-1, 8)
+
+def encode_eac(values: np.ndarray) -> np.ndarray:
+    """EAC blocks, read as 8 bit alpha or, close enough, as 11 bit R or G"""
+    values = column_major(values[:, :, None])[:, :, 0]
+    low, high = values.min(axis=1), values.max(axis=1)
+
+    # Fit each table's span to the block's range, then keep the best
+    spans = EAC_MODIFIERS.max(axis=1) - EAC_MODIFIERS.min(axis=1)
+    centers = (EAC_MODIFIERS.max(axis=1) + EAC_MODIFIERS.min(axis=1)) / 2
+    multipliers = np.clip(np.round((high - low)[:, None] / spans[None, :]), 1, 15)
+    bases = np.clip(np.round((high + low)[:, None] / 2 - multipliers * centers[None, :]), 0, 255)
+
+    decoded = np.clip(bases[:, :, None] + EAC_MODIFIERS[None, :, :] * multipliers[:, :, None], 0, 255)
+    errors = (values[:, None, :, None] - decoded[:, :, None, :]) ** 2
+    selectors = errors.argmin(axis=-1)
+    tables = errors.min(axis=-1).sum(axis=-1).argmin(axis=-1)
+
+    rows = np.arange(len(values))
+    bits = ((bases[rows, tables].astype(np.uint64) << np.uint64(56))
+        | (multipliers[rows, tables].astype(np.uint64) << np.uint64(52))
+        | (tables.astype(np.uint64) << np.uint64(48))
+        | pack_indices(selectors[rows, tables], 3, most_significant_first=True))
+    return bits.astype('>u8').view(np.uint8).reshape(-1, 8)
+
+def encode_etc2_eac(blocks: np.ndarray) -> np.ndarray:
+    return np.concatenate([encode_eac(blocks[:, :, 3]), encode_etc2(blocks)], axis=1)
+
+def encode_rg11_eac(blocks: np.ndarray) -> np.ndarray:
+    return np.concatenate([encode_eac(blocks[:, :, 0]), encode_eac(blocks[:, :, 1])], axis=1)
+
+# (Internal format, base format, encoder) for colour, colour with alpha and normal maps
+FORMATS = {
+    'bc': {
+        'color': (GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_RGB, encode_bc1),
+        'alpha': (GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_RGBA, encode_bc3),
+        'normal': (GL_COMPRESSED_RG_RGTC2, GL_RG, encode_bc5),
+    },
+    'etc2': {
+        'color': (GL_COMPRESSED_RGB8_ETC2, GL_RGB, encode_etc2),
+        'alpha': (GL_COMPRESSED_RGBA8_ETC2_EAC, GL_RGBA, encode_etc2_eac),
+        'normal': (GL_COMPRESSED_RG11_EAC, GL_RG, encode_rg11_eac),
+    },
+}
+
+def encode(pixels: np.ndarray, encoder) -> bytes:
+    blocks = to_blocks(pixels)
+    chunks = [encoder(blocks[i:i + CHUNK_SIZE]) for i in range(0, len(blocks), CHUNK_SIZE)]
+    return np.concatenate(chunks).tobytes()
+
+def mip_chain(image: Image.Image) -> list[Image.Image]:
+    levels = [image]
+    while levels[-1].width > 1 or levels[-1].height > 1:
+        previous = levels[-1]
+        size = (max(previous.width // 2, 1), max(previous.height // 2, 1))
+        levels.append(previous.resize(size, Image.BOX))
+    return levels
+
+def compress_texture(image_path: Path, texture_path: Path, format: str):
+    image = Image.open(image_path).convert('RGBA')
+    has_alpha = np.asarray(image)[:, :, 3].min() < 255
+
+    kind = 'normal' if is_normal_map(str(image_path)) else 'alpha' if has_alpha else 'color'
+    internal_format, base_format, encoder = FORMATS[format][kind]
+    levels = mip_chain(image)
+
+    os.makedirs(texture_path.parent, exist_ok=True)
+    with open(texture_path, 'wb') as out:
+        out.write(KTX_IDENTIFIER)
+        out.write(struct.pack('<13I',
+            KTX_ENDIANNESS,
+            0, 1, 0, # Type, type size and format, none for compressed data
+            internal_format, base_format,
+            image.width, image.height, 0,
+            0, 1, len(levels),
+            0)) # No key value data
+
+        for level in levels:
+            data = encode(np.asarray(level), encoder)
+            out.write(struct.pack('<I', len(data)))
+            out.write(data)
+
+def texture_name(image: str) -> str:
+    return str(Path(image).with_suffix('.ktx'))
+
+def main():
+    parser = ArgumentParser(description='Transcode textures into GPU block compressed KTX files')
+    parser.add_argument('--output-dir', type=str, required=True, help='Directory to write textures into')
+    parser.add_argument('--asset-dir', type=str, required=True, help='Directory containing the images')
+    parser.add_argument('--format', choices=FORMATS.keys(), required=True, help='BCn for desktop, or ETC2 for the web')
+    parser.add_argument('images', type=str, nargs='*', help='List of images to compress')
+    options = parser.parse_args(sys.argv[1:])
+    output_dir = Path(options.output_dir)
+    asset_dir = Path(options.asset_dir)
+
+    # Changing format must rebuild every texture
+    format_path = output_dir.joinpath('textures/format.txt')
+    is_same_format = format_path.exists() and format_path.read_text() == options.format
+
+    for image in options.images:
+        image_path = asset_dir.joinpath(image)
+        texture_path = output_dir.joinpath(texture_name(image))
+        if is_same_format and texture_path.exists() and texture_path.stat().st_mtime >= image_path.stat().st_mtime:
+            continue
+
+        print(f' -> { texture_name(image) }')
+        compress_texture(image_path, texture_path, options.format)
+
+    os.makedirs(format_path.parent, exist_ok=True)
+    format_path.write_text(options.format)
+
+if __name__ == '__main__':
+    main()